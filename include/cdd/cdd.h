@@ -103,7 +103,7 @@
  * @subsection Initialisation
  *
  * Before use, the library must be initialised by calling \c
- * cdd_init(), boolean variables must be added by calling \c
+ * cdd_init() or \c cdd_init_ex(), boolean variables must be added by calling \c
  * cdd_add_bddvar(), and clock variables must be added by calling \c
  * cdd_add_clocks().
  *
@@ -217,6 +217,62 @@ typedef struct s_CddRehashStat
     int64_t sumtime; /**< Accumulated time used to rehash */
 } CddRehashStat;
 
+/** Counters of an operation cache. Misses are lookups without a hit. */
+typedef struct cdd_cache_stats
+{
+    int64_t size;       /**< Number of entries */
+    int64_t lookups;    /**< Number of lookups */
+    int64_t hits;       /**< Number of lookups finding the result */
+    int64_t overwrites; /**< Number of results replacing another one */
+} cdd_cache_stats;
+
+/** Counters of the unique table of one level of a node manager. */
+typedef struct cdd_level_stats
+{
+    int32_t level;   /**< The level */
+    int32_t keys;    /**< Number of nodes, including dead ones */
+    int32_t buckets; /**< Size of hash table */
+    double chain;    /**< Average length of the non-empty hash chains */
+    int64_t lookups; /**< Number of lookups */
+    int64_t inserts; /**< Number of nodes created */
+} cdd_level_stats;
+
+/** Counters of a node manager, which holds the nodes of one type and arity. */
+typedef struct cdd_manager_stats
+{
+    int32_t type;              /**< \c TYPE_BDD or \c TYPE_CDD */
+    int32_t arity;             /**< Number of children of a node */
+    int32_t alive;             /**< Number of referenced nodes */
+    int32_t dead;              /**< Number of unreferenced nodes not yet collected */
+    int32_t free;              /**< Number of free nodes */
+    int32_t peak;              /**< Max. number of alive and dead nodes */
+    int64_t chunkbytes;        /**< Bytes in chunks */
+    int64_t reclaims;          /**< Number of dead nodes brought back to life */
+    int32_t gbcnum;            /**< Number of garbage collections */
+    int32_t levelnum;          /**< Number of entries in \a levels */
+    cdd_level_stats* levels;   /**< The levels with a unique table */
+} cdd_manager_stats;
+
+/** Counters of the library, see \c cdd_get_stats(). */
+typedef struct cdd_stats
+{
+    cdd_cache_stats apply;        /**< Cache of the binary operations */
+    cdd_cache_stats quant;        /**< Cache of quantification, resets and delays */
+    cdd_cache_stats replace;      /**< Cache of cdd_replace() */
+    cdd_cache_stats relax;        /**< Cache of the relaxation of bounds */
+    cdd_cache_stats and_exist;    /**< Cache of cdd_and_exist() */
+    int32_t alive;                /**< Number of referenced nodes */
+    int32_t dead;                 /**< Number of unreferenced nodes not yet collected */
+    int32_t free;                 /**< Number of free nodes */
+    int32_t peak;                 /**< Max. number of alive and dead nodes */
+    int64_t chunkbytes;           /**< Bytes in chunks */
+    int64_t reclaims;             /**< Number of dead nodes brought back to life */
+    int32_t gbcnum;               /**< Number of garbage collections */
+    int32_t rehashnum;            /**< Number of rehashes */
+    int32_t managernum;           /**< Number of entries in \a managers */
+    cdd_manager_stats* managers;  /**< The node managers in use, BDD first */
+} cdd_stats;
+
 /** Structure with information about a level in a decision diagram */
 typedef struct
 {
@@ -226,6 +282,23 @@ typedef struct
     int32_t diff;   /**< Encoding of clock1 - clock2 */
 } LevelInfo;
 
+/** Opaque frame of a zone iterator. @see cdd_zone_iterator */
+typedef struct cdd_zone_frame_ cdd_zone_frame;
+
+/**
+ * State of a depth first walk over the zones of a CDD.
+ * @see cdd_zone_iterator_init()
+ */
+typedef struct
+{
+    uint32_t dim;           /**< Dimension of the extracted zones */
+    int32_t depth;          /**< Number of active frames */
+    int32_t capacity;       /**< Number of allocated frames */
+    ddNode* pending;        /**< Node to visit next, or NULL */
+    cdd_zone_frame* frames; /**< One frame per CDD node on the path */
+    raw_t* dbms;            /**< One dbm per frame plus one */
+} cdd_zone_iterator;
+
 #define cdd_difference_count(n) (((n) * ((n) - 1)) >> 1)
 #define cdd_difference(c, d)    (cdd_difference_count(c) + (d))
 // #define CDD_DIFF(c,d) ((c) << 10 | (d))
@@ -246,9 +319,56 @@ typedef struct
  * @param cs        number of entries in operation cache.
  * @param stacksize size of stack used to keep temporary references.
  * @return 0 on success, or a non-zero error code on failure
+ * @see cdd_init_ex
  */
 extern int32_t cdd_init(int32_t maxsize, int32_t cs, size_t stacksize);
 
+/**
+ * Options for \c cdd_init_ex(). Initialise them with \c
+ * cdd_default_options() and change the fields of interest.
+ */
+typedef struct cdd_options
+{
+    int32_t maxsize;               ///< Max. arity of a decision diagram node
+    size_t stacksize;              ///< Size of stack used to keep temporary references
+    int32_t apply_cache;           ///< Entries in the cache of the binary operations
+    int32_t quant_cache;           ///< Entries in the cache of quantification, resets and delays
+    int32_t replace_cache;         ///< Entries in the cache of cdd_replace()
+    int32_t relax_cache;           ///< Entries in the cache of the relaxation of bounds
+    int32_t and_exist_cache;       ///< Entries in the cache of cdd_and_exist()
+    int32_t bdd_nodes;             ///< BDD nodes to allocate up front
+    int32_t cdd_nodes;             ///< CDD nodes to allocate up front for each arity used
+    int32_t buckets;               ///< Initial buckets of a subtable, rounded up to a power of two
+    const int32_t* level_buckets;  ///< Initial buckets per level overriding \a buckets if positive, or NULL
+    int32_t level_count;           ///< Number of entries in \a level_buckets
+    int32_t hash_density;          ///< Avg. keys per bucket before a subtable is rehashed
+    int32_t gbc_threshold;         ///< Free nodes in percent under which cdd_gbc() collects
+    int32_t gbc_minfree;           ///< Dead nodes in percent needed to collect rather than grow
+    void* (*chunk_alloc)(size_t size);  ///< Allocates a node chunk aligned to its size, or NULL
+    void (*chunk_free)(void* chunk);    ///< Releases a chunk returned by \a chunk_alloc
+} cdd_options;
+
+/**
+ * Fills in the options used by \c cdd_init(maxsize, cs, stacksize):
+ * every cache gets \a cs entries, nothing is allocated up front and
+ * node chunks come from the operating system.
+ * @param options the options to initialise
+ * @param maxsize the maximum arity of a decision diagram node.
+ * @param cs      number of entries in each operation cache.
+ * @param stacksize size of stack used to keep temporary references.
+ */
+extern void cdd_default_options(cdd_options* options, int32_t maxsize, int32_t cs, size_t stacksize);
+
+/**
+ * Initialise CDD library with the given options. A known large
+ * workload can allocate its nodes and size its subtables up front
+ * instead of growing them while it runs. The options are copied.
+ * @param options the options, see \c cdd_default_options()
+ * @return 0 on success, \c CDD_RANGE for an empty cache or subtable,
+ * or another non-zero error code on failure
+ */
+extern int32_t cdd_init_ex(const cdd_options* options);
+
 /**
  * Deinitialized CDD library. This method frees all resources allocated
  * by the library.
@@ -265,7 +385,8 @@ extern void cdd_ensure_running();
  * Declares a number of BDD variables. The library maintains a list of
  * boolean and clock variables. This function adds more BDD variable
  * to this list. Each BDD variable is identified by a \a level
- * (counting from 0).
+ * (counting from 0): the level it is added at. It keeps this
+ * identification when reordering moves it to another level.
  * @param n the number of BDD variables to add
  * @return the level of the first BDD variable added
  */
@@ -289,6 +410,20 @@ extern ddNode* cdd_remove_negative(ddNode* node);
  */
 extern void cdd_add_clocks(int32_t n);
 
+/**
+ * Declares a number of clock variables like \c cdd_add_clocks(), but
+ * orders the new difference levels by a dependency graph. Clocks
+ * constrained together are given in pairs, e.g. by the guards and
+ * invariants of a model. The new clocks are placed one by one, taking
+ * the clock depending on most of the clocks already placed, and each
+ * gets the levels of its differences to the clocks placed before it,
+ * those it depends on first.
+ * @param n the number of clocks to add
+ * @param deps \a ndeps pairs of clocks, counting the reference clock 0
+ * @param ndeps the number of pairs
+ */
+extern void cdd_add_clocks_ordered(int32_t n, const int32_t* deps, int32_t ndeps);
+
 #ifdef MULTI_TERMINAL
 
 /**
@@ -450,12 +585,120 @@ extern void cdd_default_rehashhandler(CddRehashStat* info);
 /**
  * Trigger a garbage collector. The library will automatically run
  * the garbage collector when needed, but it can be triggered manually with
- * this function.
+ * this function. If automatic reordering is enabled, the variables
+ * are reordered afterwards when needed.
+ * @see cdd_autoreorder
  */
 extern void cdd_gbc();
 
+/**
+ * Reads the performance counters of the library. The counters are
+ * always kept, since they only cost an increment on each cache and
+ * unique table access. The arrays of the result are allocated and
+ * must be released with \c cdd_free_stats().
+ * @param stats the statistics to fill in
+ * @return 0 on success, \c CDD_MEMORY if the arrays cannot be allocated
+ * @see cdd_reset_stats
+ */
+extern int32_t cdd_get_stats(cdd_stats* stats);
+
+/**
+ * Releases the arrays allocated by \c cdd_get_stats().
+ * @param stats statistics filled in by \c cdd_get_stats()
+ */
+extern void cdd_free_stats(cdd_stats* stats);
+
+/**
+ * Resets the lookup, hit, overwrite, insert and reclaim counters, for
+ * instance between the phases of a verification. The peak node counts
+ * start over from the current number of nodes.
+ */
+extern void cdd_reset_stats();
+
+/**
+ * Swaps the variables at \a level and \a level + 1, which are either
+ * both BDD variables or both clock differences. The nodes are updated
+ * in place, so existing references to decision diagrams stay valid and
+ * keep their meaning, and \c cdd_diff2level and the level information
+ * follow the clock differences. A CDD node cannot change its number of
+ * children in place, so two clock differences are only swapped if no
+ * node would have to. Must not be called while an operation or a zone
+ * iterator is in progress.
+ * @param level a level followed by another level of the same type
+ * @return 0 on success, \c CDD_VAR if the levels are of different
+ * types, \c CDD_SWAP if the clock differences cannot be swapped.
+ */
+extern int32_t cdd_swap_levels(int32_t level);
+
+/**
+ * Reorders the variables by sifting: each variable in turn is moved
+ * through the consecutive levels of its type around it and left where
+ * the number of nodes of that type is smallest. A clock difference
+ * does not move past a level it cannot be swapped with (see \c
+ * cdd_swap_levels()), and BDD levels stay below the clock difference
+ * levels. Must not be called while an operation or a zone iterator is
+ * in progress.
+ * @return the number of nodes in use afterwards.
+ */
+extern int32_t cdd_reorder();
+
+/**
+ * Enables automatic reordering: \c cdd_reorder() is called when more
+ * than \a threshold nodes are in use, after which the threshold is
+ * raised to twice the number of nodes left. The count is checked on
+ * entry to \c cdd_apply() and \c cdd_apply_reduce(), and by \c
+ * cdd_gbc(), but not while a zone iterator is in progress. As for
+ * garbage collection, the diagrams held by the caller must be
+ * referenced.
+ * @param threshold the number of nodes, or 0 to disable.
+ */
+extern void cdd_autoreorder(int32_t threshold);
+
 /** @} */
 
+#ifdef CDD_TRACE
+/**
+ * @name Tracing
+ * Available when the library is built with \c CDD_TRACE, i.e. with
+ * the CMake option \c UCDD_WITH_TRACE.
+ * @{
+ */
+
+/**
+ * Starts recording the top level calls of \c cdd_apply(),
+ * \c cdd_apply_reduce(), \c cdd_reduce(), \c cdd_exist(),
+ * \c cdd_delay(), \c cdd_predt() and \c cdd_transition(), together
+ * with the garbage collections and rehashes, in a ring buffer of \a
+ * events entries. Previously recorded events are discarded and once
+ * the buffer is full the oldest events are overwritten. The nodes of
+ * the operands and the result of each recorded operation are counted
+ * outside of its duration, but this still slows down the run.
+ * @param events the size of the ring buffer
+ * @return 0 on success, \c CDD_MEMORY if the buffer cannot be allocated
+ */
+extern int32_t cdd_trace_start(size_t events);
+
+/**
+ * Stops recording. The recorded events are kept until the next
+ * \c cdd_trace_start() or \c cdd_done().
+ */
+extern void cdd_trace_stop();
+
+/** Returns the number of events in the ring buffer. */
+extern size_t cdd_trace_size();
+
+/**
+ * Writes the events in the ring buffer to \a out in the JSON format of
+ * the Chrome trace viewer, which can also be loaded in Perfetto.
+ * Times are in microseconds from \c cdd_trace_start().
+ * @param out the file to write to
+ * @return 0 on success, \c CDD_FILE if writing fails
+ */
+extern int32_t cdd_trace_dump(FILE* out);
+
+/** @} */
+#endif
+
 // extern int32_t         cdd_setmaxnodenum(int);
 // extern int32_t         cdd_setminfreenodes(int);
 
@@ -487,10 +730,10 @@ extern ddNode* cdd_upper(int32_t i, int32_t j, raw_t bound);
 extern ddNode* cdd_interval(int32_t i, int32_t j, raw_t lower, raw_t upper);
 
 /**
- * Creates a BDD node. The boolean variable is identified by the node
- * level. The level must correspond to a BDD variable (as opposed to
- * a clock difference).
- * @param level a node level
+ * Creates a BDD node. The boolean variable is identified by the
+ * level it was added at, see \c cdd_add_bddvar(). The level must
+ * correspond to a BDD variable (as opposed to a clock difference).
+ * @param level the level of the variable
  * @return a BDD node
  */
 extern ddNode* cdd_bddvar(int32_t level);
@@ -542,9 +785,104 @@ extern int32_t cdd_edgecount(ddNode* dd);
 
 /**
  * Existential quantification. @todo
+ * The result is cached on the set of quantified variables, so repeated
+ * calls with the same variables in any order are answered from the
+ * cache.
  */
 extern ddNode* cdd_exist(ddNode*, int32_t*, int32_t*, int32_t, int32_t);
 
+/**
+ * Existential quantification of a conjunction, without building the
+ * conjunction first. Equivalent to quantifying the variables of \c
+ * cdd_exist() in \a l & \a r. The result for a pair of diagrams is
+ * cached on the set of quantified variables like for \c cdd_exist().
+ * @param l a decision diagram
+ * @param r a decision diagram
+ * @param levels_bool array of boolean variables to quantify
+ * @param clocks array of clocks to quantify
+ * @param num_bool_resets the number of boolean variables to quantify
+ * @param num_clock_resets the number of clocks to quantify
+ * @return the quantified conjunction of \a l and \a r
+ */
+extern ddNode* cdd_and_exist(ddNode* l, ddNode* r, int32_t* levels_bool, int32_t* clocks, int32_t num_bool_resets,
+                             int32_t num_clock_resets);
+
+/**
+ * Clock reset. Quantifies the clocks away and constrains them to
+ * their new values, without splitting \a node into zones.
+ * @param node a decision diagram
+ * @param clocks array of \a n clocks to reset
+ * @param values array of the \a n values the clocks are reset to
+ * @param n the number of clocks to reset
+ * @return \a node with the clocks reset
+ */
+extern ddNode* cdd_reset(ddNode* node, int32_t* clocks, int32_t* values, int32_t n);
+
+/**
+ * Image of a transition. Restricts \a state to \a guard and the
+ * non-negative clock valuations, quantifies the reset clocks and
+ * boolean variables in a single pass and constrains them to their new
+ * values.
+ * @param state the source states
+ * @param guard the guard of the transition
+ * @param clocks array of clocks to reset
+ * @param clock_values array of the values the clocks are reset to
+ * @param num_clocks the number of clocks to reset
+ * @param bools array of boolean node levels to reset
+ * @param bool_values array of the values the booleans are reset to
+ * @param num_bools the number of booleans to reset
+ * @return the target states of the transition
+ */
+extern ddNode* cdd_image(ddNode* state, ddNode* guard, int32_t* clocks, int32_t* clock_values, int32_t num_clocks,
+                         int32_t* bools, int32_t* bool_values, int32_t num_bools);
+
+/**
+ * Backward image of a transition. Restricts \a state to \a update and
+ * the non-negative clock valuations, quantifies the reset clocks and
+ * boolean variables in a single pass and restricts the result to
+ * \a guard.
+ * @param state the target states
+ * @param guard the guard of the transition
+ * @param update the values assigned by the transition
+ * @param clocks array of reset clocks
+ * @param num_clocks the number of reset clocks
+ * @param bools array of reset boolean node levels
+ * @param num_bools the number of reset booleans
+ * @return the source states of the transition
+ */
+extern ddNode* cdd_preimage(ddNode* state, ddNode* guard, ddNode* update, int32_t* clocks, int32_t num_clocks,
+                            int32_t* bools, int32_t num_bools);
+
+/**
+ * Delay operation. Computes the valuations reachable from the
+ * non-negative part of \a node by letting time elapse. The operation
+ * works directly on the structure of the diagram rather than on its
+ * zones.
+ * @param node a decision diagram
+ * @return the future of \a node
+ */
+extern ddNode* cdd_delay(ddNode* node);
+
+/**
+ * Delay operation restricted to an invariant. Equivalent to the
+ * intersection of \c cdd_delay(node) with \a inv, but parts of the
+ * future outside \a inv are pruned during the traversal.
+ * @param node a decision diagram
+ * @param inv the invariant
+ * @return the future of \a node within \a inv
+ */
+extern ddNode* cdd_delay_invariant(ddNode* node, ddNode* inv);
+
+/**
+ * Inverse delay operation. Computes the non-negative valuations from
+ * which the non-negative part of \a node can be reached by letting
+ * time elapse. Like \c cdd_delay() it works on the structure of the
+ * diagram.
+ * @param node a decision diagram
+ * @return the past of \a node
+ */
+extern ddNode* cdd_past(ddNode* node);
+
 /**
  * Variable substitution. @todo
  */
@@ -555,6 +893,25 @@ extern ddNode* cdd_replace(ddNode*, int32_t*, int32_t*);
  */
 extern ddNode* cdd_ite(ddNode*, ddNode*, ddNode*);
 
+/**
+ * Computes the conjunction of \a k decision diagrams. The operands
+ * are combined in a balanced reduction tree, which is considerably
+ * faster than conjoining them one by one onto an accumulator.
+ * @param parts an array of \a k decision diagrams
+ * @param k the number of operands
+ * @return the conjunction of all operands (\c cddtrue if \a k is 0)
+ */
+extern ddNode* cdd_and_n(ddNode** parts, size_t k);
+
+/**
+ * Computes the disjunction of \a k decision diagrams.
+ * @param parts an array of \a k decision diagrams
+ * @param k the number of operands
+ * @return the disjunction of all operands (\c cddfalse if \a k is 0)
+ * @see cdd_and_n
+ */
+extern ddNode* cdd_or_n(ddNode** parts, size_t k);
+
 /**
  * Another reduced form? @todo
  */
@@ -574,6 +931,46 @@ extern ddNode* cdd_reduce2(ddNode*);
  */
 extern int32_t cdd_contains(ddNode* cdd, raw_t* dbm, uint32_t dim);
 
+/**
+ * Checks for each of a number of DBMs whether it is included in the
+ * CDD. The DBMs are passed down the diagram together, so the part of
+ * the walk they have in common is only done once.
+ * @param cdd a cdd
+ * @param dbms an array of \a n dbms
+ * @param n the number of dbms
+ * @param dim the dimension of the dbms
+ * @param results an array of \a n results, set to 1 if the dbm is
+ *        included in \a cdd and to 0 otherwise
+ */
+extern void cdd_contains_many(ddNode* cdd, const raw_t* const* dbms, size_t n, uint32_t dim, int32_t* results);
+
+/**
+ * Returns true if a point is included in the CDD. The point is an
+ * integer valuation of the clocks together with a value of every
+ * boolean variable.
+ * @param cdd a cdd
+ * @param clocks the value of each clock, indexed by clock number and
+ *        with \a clocks[0] = 0
+ * @param bools the value of each boolean variable, indexed by its
+ *        level as passed to cdd_bddvar()
+ * @return true if the point is included in \a cdd
+ */
+extern int32_t cdd_eval_point(ddNode* cdd, const int32_t* clocks, const bool* bools);
+
+/**
+ * Evaluates a number of points like cdd_eval_point(). The points are
+ * passed down the diagram together and every node is visited once for
+ * all the points that reach it.
+ * @param cdd a cdd
+ * @param clocks an array of \a n clock valuations
+ * @param bools an array of \a n boolean valuations
+ * @param n the number of points
+ * @param results an array of \a n results, set to 1 if the point is
+ *        included in \a cdd and to 0 otherwise
+ */
+extern void cdd_eval_points(ddNode* cdd, const int32_t* const* clocks, const bool* const* bools, size_t n,
+                            int32_t* results);
+
 /**
  * Convert a DBM to a CDD. It is important that the indexes of the DBM
  * correspond to clocks in the CDD library.
@@ -582,6 +979,18 @@ extern int32_t cdd_contains(ddNode* cdd, raw_t* dbm, uint32_t dim);
  */
 extern ddNode* cdd_from_dbm(const raw_t* dbm, uint32_t dim);
 
+/**
+ * Convert a set of DBMs to a CDD representing their union. The zones
+ * are grouped by their constraints level by level and the diagram is
+ * built in one pass, which is much faster than converting the zones
+ * one at a time and joining the results.
+ * @param dbms an array of \a n dbms
+ * @param n the number of dbms
+ * @param dim the dimension of the dbms
+ * @return a CDD equivalent to the union of \a dbms
+ */
+extern ddNode* cdd_from_dbms(const raw_t* const* dbms, size_t n, uint32_t dim);
+
 /**
  * Extract a zone from a CDD.  This function will extract a zone from
  * \a cdd and write it to \a dbm.  It will return a CDD equivalent to
@@ -593,6 +1002,20 @@ extern ddNode* cdd_from_dbm(const raw_t* dbm, uint32_t dim);
  */
 extern ddNode* cdd_extract_dbm(ddNode* cdd, raw_t* dbm, uint32_t dim);
 
+/**
+ * Extract a zone from a CDD like cdd_extract_dbm(), but grow it
+ * greedily. The intervals along the path of cdd_extract_dbm() are
+ * widened into the neighbouring children as long as the zone stays
+ * inside \a cdd and ends in the same BDD node, so each extraction
+ * removes as much of \a cdd as possible.
+ * PRECONDITION: call CDD reduce first!!!
+ * @param cdd a cdd
+ * @param dbm a dbm
+ * @return the difference between \a cdd and \a dbm, or NULL if out
+ * of memory
+ */
+extern ddNode* cdd_extract_dbm_greedy(ddNode* cdd, raw_t* dbm, uint32_t dim);
+
 /**
  * Extract a BDD from the bottom of a given CDD.
  * PRECONDITION: call CDD reduce first!!!
@@ -602,6 +1025,37 @@ extern ddNode* cdd_extract_dbm(ddNode* cdd, raw_t* dbm, uint32_t dim);
  */
 extern ddNode* cdd_extract_bdd(ddNode* cdd, uint32_t dim);
 
+/**
+ * Prepare a walk over the zones of \a cdd. Every consistent path
+ * from the root to a BDD node or a terminal yields one zone: the
+ * non-negative dbm of the clock constraints along the path together
+ * with the BDD node at the bottom of the path. No nodes are created,
+ * but \a cdd must stay referenced until the walk is done. Automatic
+ * reordering waits until the walk is done.
+ * @param it the iterator to initialise
+ * @param cdd a cdd
+ * @param dim the dimension of the extracted zones
+ * @see cdd_zone_iterator_next()
+ */
+extern void cdd_zone_iterator_init(cdd_zone_iterator* it, ddNode* cdd, uint32_t dim);
+
+/**
+ * Extract the next zone of a walk.
+ * @param it the iterator
+ * @param dbm a dbm of dimension \a it->dim receiving the zone
+ * @param bdd receives the BDD part of the zone, \c cddtrue if the
+ *      path ends in a terminal
+ * @return 1 if a zone was extracted, 0 if the walk is done
+ */
+extern int32_t cdd_zone_iterator_next(cdd_zone_iterator* it, raw_t* dbm, ddNode** bdd);
+
+/**
+ * Release the memory held by a zone iterator. Must be called for
+ * every initialised iterator.
+ * @param it the iterator
+ */
+extern void cdd_zone_iterator_done(cdd_zone_iterator* it);
+
 /**
  * Print a CDD \a r as a dot input file \a ofile.\n\n
  *
@@ -704,8 +1158,9 @@ extern ddNode* cddtrue;
 #define CDD_STACKOVERFLOW (-19) /**< Reference stack overflow */
 #define CDD_NODE          (-20) /**< Invalid node type */
 #define CDD_MAXSIZE       (-21) /**< CDD Node larger than maximum allowed */
+#define CDD_SWAP          (-22) /**< Levels cannot be swapped in place */
 
-#define CDD_ERRNUM 21
+#define CDD_ERRNUM 22
 
 /** @} error codes */
 
@@ -862,6 +1317,7 @@ private:
     friend cdd cdd_bddnvarpp(int);
     friend cdd cdd_remove_negative(const cdd& node);
     friend cdd cdd_exist(const cdd&, int32_t*, int32_t*, int32_t, int32_t);
+    friend cdd cdd_reset(const cdd&, int32_t*, int32_t*, int32_t);
     friend cdd cdd_replace(const cdd&, int32_t*, int32_t*);
     friend int32_t cdd_nodecount(const cdd&);
     friend cdd cdd_apply(const cdd&, const cdd&, int);
@@ -884,9 +1340,15 @@ private:
     friend cdd cdd_transition_back_past(const cdd& state, const cdd& guard, const cdd& update, int32_t* clock_resets,
                                         int32_t num_clock_resets, int32_t* bool_resets, int32_t num_bool_resets);
     friend cdd cdd_predt(const cdd& target, const cdd& safe);
+    friend cdd cdd_predt(const cdd& target, const cdd& safe, uint32_t num_threads);
     friend cdd cdd_reduce2(const cdd&);
     friend bool cdd_contains(const cdd&, raw_t* dbm, uint32_t dim);
+    friend void cdd_contains_many(const cdd&, const raw_t* const* dbms, size_t n, uint32_t dim, int32_t* results);
+    friend bool cdd_eval_point(const cdd&, const int32_t* clocks, const bool* bools);
+    friend void cdd_eval_points(const cdd&, const int32_t* const* clocks, const bool* const* bools, size_t n,
+                                int32_t* results);
     friend cdd cdd_extract_dbm(const cdd&, raw_t* dbm, uint32_t dim);
+    friend cdd cdd_extract_dbm_greedy(const cdd&, raw_t* dbm, uint32_t dim);
     friend cdd cdd_extract_bdd(const cdd&, uint32_t dim);
     friend extraction_result cdd_extract_bdd_and_dbm(const cdd&);
     friend void cdd_fprintdot(FILE* ofile, const cdd&, bool push_negate);
@@ -930,6 +1392,22 @@ typedef struct bdd_arrays
  */
 inline bool cdd_contains(const cdd& c, raw_t* dbm, uint32_t dim) { return cdd_contains(c.handle(), dbm, dim); }
 
+inline void cdd_contains_many(const cdd& c, const raw_t* const* dbms, size_t n, uint32_t dim, int32_t* results)
+{
+    cdd_contains_many(c.handle(), dbms, n, dim, results);
+}
+
+inline bool cdd_eval_point(const cdd& c, const int32_t* clocks, const bool* bools)
+{
+    return cdd_eval_point(c.handle(), clocks, bools);
+}
+
+inline void cdd_eval_points(const cdd& c, const int32_t* const* clocks, const bool* const* bools, size_t n,
+                            int32_t* results)
+{
+    cdd_eval_points(c.handle(), clocks, bools, n, results);
+}
+
 /**
  * AND operator. Computes the conjunction of the two operands.
  */
@@ -940,6 +1418,19 @@ inline cdd operator&(const cdd& l, const cdd& r) { return cdd_apply(l, r, cddop_
  */
 inline cdd cdd_ite(const cdd& f, const cdd& g, const cdd& h) { return (f & g) | ((!f) & h); }
 
+/**
+ * Conjunction of \a k cdds.
+ * @see cdd_and_n(ddNode**, size_t)
+ */
+cdd cdd_and_n(const cdd* parts, size_t k);
+
+/**
+ * Disjunction of \a k cdds. Use this instead of accumulating a union
+ * with <tt>res |= piece</tt> in a loop.
+ * @see cdd_or_n(ddNode**, size_t)
+ */
+cdd cdd_or_n(const cdd* parts, size_t k);
+
 /**
  * Creates a new CDD node corresponding to the constraint \a i - \a j
  * <~ \a bound, where \a i and \a j are indexes of clocks and \a bound
@@ -1035,6 +1526,11 @@ inline cdd cdd_exist(const cdd& r, int32_t* levels, int32_t* clocks, int32_t num
     return cdd(cdd_exist(r.root, levels, clocks, num_bools, num_clocks));
 }
 
+inline cdd cdd_reset(const cdd& r, int32_t* clocks, int32_t* values, int32_t n)
+{
+    return cdd(cdd_reset(r.root, clocks, values, n));
+}
+
 /**
  * Variable substitution.
  * @todo
@@ -1103,6 +1599,19 @@ inline cdd cdd_extract_dbm(const cdd& r, raw_t* dbm, uint32_t dim)
     return cdd(cdd_extract_dbm(r.handle(), dbm, dim));
 }
 
+/**
+ * Extract a zone from a CDD, growing it greedily.
+ * @param cdd a cdd
+ * @param dbm a dbm
+ * @param dim the dimension of the dbm
+ * @return the difference between \a cdd and \a dbm
+ * @see cdd_extract_dbm_greedy(ddNode*, raw_t*, uint32_t)
+ */
+inline cdd cdd_extract_dbm_greedy(const cdd& r, raw_t* dbm, uint32_t dim)
+{
+    return cdd(cdd_extract_dbm_greedy(r.handle(), dbm, dim));
+}
+
 /**
  * Extract the bottom BDD of the first DBM in a given CDD.
  * @param cdd a cdd
@@ -16,6 +16,8 @@
 #include "cdd/cdd.h"
 #include "cdd/config.h"
 
+#include <stddef.h>  // offsetof
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -105,7 +107,7 @@ extern "C" {
  *  The allowed number of variables (BDD+CDD) must
  *  be < MAXLEVEL.
  */
-#define MAXLEVEL ((1 << 20) - 1)
+#define MAXLEVEL ((1 << 19) - 1)
 
 /** Increment references on \a node */
 #define cdd_ref(node) (cdd_satinc(cdd_rglr(node)->ref))
@@ -122,11 +124,27 @@ extern "C" {
 #ifdef MULTI_TERMINAL
 int32_t cdd_isterminal(ddNode*);
 int32_t cdd_is_extra_terminal(ddNode*);
+
+/** Returns true if \a node is a terminal, extra terminals included */
+#define cdd_isterminal(node) (cdd_rglr(node)->level == MAXLEVEL)
+
+/** Returns true if \a node is an extra terminal */
+#define cdd_is_extra_terminal(node) (cdd_rglr(node) != cddfalse && cdd_isterminal(node))
 #else
 /** Returns true if \a node is a terminal */
 #define cdd_isterminal(node) (cdd_rglr(node) == cddfalse)
 #endif
 
+/** Returns a key for \a node that is independent of its address: the
+ *  creation number of the node with the negation bit appended. Used
+ *  wherever nodes are ordered or hashed, such that runs on the same
+ *  input do the same work on every platform.
+ */
+#define cdd_node_key(node) ((uint32_t)((cdd_rglr(node)->uid << 1) | cdd_mask(node)))
+
+/** Returns TYPE_CDD or TYPE_BDD for a node that is not a terminal */
+#define cdd_node_type(node) (cdd_rglr(node)->type)
+
 /**
  * @return 1 if the node is a terminal true or false.
  * This is useful for the case of multi-terminals.
@@ -247,9 +265,11 @@ typedef uint32_t (*NodeHashFunc)(NodeManager*, ddNode*);
 struct node_
 {
     ddNode* next;         ///< Pointer to next element in hash table
-    uint32_t level : 20;  ///< Level of the node
+    uint32_t level : 19;  ///< Level of the node
+    uint32_t type : 1;    ///< TYPE_CDD or TYPE_BDD, unused in terminals
     uint32_t ref : 10;    ///< Reference count
     uint32_t flag : 2;    ///< Flag used when marking nodes
+    uint32_t uid;         ///< Creation number, used for ordering and hashing
 };
 
 /**
@@ -258,15 +278,17 @@ struct node_
 struct xtermnode_
 {
     ddNode* next;         ///< Pointer to next element in hash table
-    uint32_t level : 20;  ///< Level of the node
+    uint32_t level : 19;  ///< Level of the node
+    uint32_t type : 1;    ///< TYPE_CDD or TYPE_BDD, unused in terminals
     uint32_t ref : 10;    ///< Reference count
     uint32_t flag : 2;    ///< Flag used when marking nodes
+    uint32_t uid;         ///< Creation number, used for ordering and hashing
     int32_t id;
 };
 
 /**
  * An element is a pair containing a reference to a DD node and a
- * bound.  It is used in the definition of a CDD node.
+ * bound.  It is used on the reference stack when building CDD nodes.
  */
 
 struct elem_
@@ -277,17 +299,35 @@ struct elem_
 
 /**
  * A CDD node. The first fields are identical to that of \c node_.
- * A CDD node has two or more children.
+ * A CDD node has two or more children. The elements are stored as
+ * the array of upper bounds, ending with INF, followed by the array
+ * of children, so the bounds can be searched without touching the
+ * children.
  */
 struct cddnode_
 {
     ddNode* next;         ///< Pointer to next element in hash table
-    uint32_t level : 20;  ///< Level of the node
+    uint32_t level : 19;  ///< Level of the node
+    uint32_t type : 1;    ///< TYPE_CDD or TYPE_BDD, unused in terminals
     uint32_t ref : 10;    ///< Reference count
     uint32_t flag : 2;    ///< Flag used when marking nodes
-    Elem elem[];          ///< NULL terminated array of elements
+    uint32_t uid;         ///< Creation number, used for ordering and hashing
+    uint32_t len;         ///< Number of elements
+    raw_t bnd[];          ///< Upper bounds, followed by the children
 };
 
+/** Offset in bytes of the bounds in a CDD node */
+#define cdd_bnd_offset (offsetof(cddNode, bnd))
+
+/** Size in bytes of the bounds of a CDD node with \a len elements,
+    padded such that the children are aligned within the node. */
+#define cdd_bnd_span(len)                                                                           \
+    (((cdd_bnd_offset + (len) * sizeof(raw_t) + sizeof(ddNode*) - 1) & ~(sizeof(ddNode*) - 1)) - \
+     cdd_bnd_offset)
+
+/** Size in bytes of the elements of a CDD node with \a len elements */
+#define cdd_elem_size(len) (cdd_bnd_span(len) + (len) * sizeof(ddNode*))
+
 /**
  * A BDD node. The first fields are identical to that of \c node_.
  * A BDD node has two children: a low node and a high node.
@@ -295,9 +335,11 @@ struct cddnode_
 struct bddnode_
 {
     ddNode* next;         ///< Pointer to next element in hash table
-    uint32_t level : 20;  ///< Level of the node
+    uint32_t level : 19;  ///< Level of the node
+    uint32_t type : 1;    ///< TYPE_CDD or TYPE_BDD, unused in terminals
     uint32_t ref : 10;    ///< Reference count
     uint32_t flag : 2;    ///< Flag used when marking nodes
+    uint32_t uid;         ///< Creation number, used for ordering and hashing
     ddNode* low;          ///< Low child node
     ddNode* high;         ///< High child node
 };
@@ -334,6 +376,8 @@ struct subtable_
     int32_t shift;    ///< Shift for hash
     int32_t buckets;  ///< Size of hash table
     ddNode** hash;    ///< Hash table
+    int64_t lookups;  ///< Number of lookups
+    int64_t inserts;  ///< Number of nodes created
 };
 
 /**
@@ -358,6 +402,8 @@ struct nodemanager_
     int32_t usedcnt;   ///< Number of used nodes
     int32_t gbccnt;    ///< Number of garbage collection runs on this manager
     int32_t gbcclock;  ///< Time used for garbage collection
+    int32_t peakcnt;   ///< Max. number of used and dead nodes
+    int64_t reclaimcnt;  ///< Number of dead nodes reclaimed
     // int32_t gbcwatch;      ///< True if scheduled for garbage collection
     ddNode* free;      ///< Free list
     Chunk* nodes;      ///< Chunk list
@@ -420,6 +466,8 @@ ddNode* cdd_make_cdd_node(int32_t level, Elem* children, int32_t len);
 
 extern int32_t cdd_errorcond;
 extern int32_t* cdd_diff2level;
+extern int32_t* cdd_var2level;  ///< Current level of a variable, identified by the level it was added at
+extern int32_t* cdd_level2var;  ///< Variable at a level
 extern Elem* cdd_refstack;
 extern Elem* cdd_refstacktop;  ///< Reference stack
 extern size_t cdd_refstacksize;
@@ -427,6 +475,7 @@ extern int32_t bdd_start_level;  ///< BDD start level
 extern int32_t cdd_clocknum;     ///< Number of clocks
 extern int32_t cdd_varnum;       ///< Number of BDD variables
 extern int32_t cdd_levelcnt;     ///< Number of levels
+extern int32_t cdd_maxcddsize;   ///< Max. arity of a node
 extern LevelInfo* cdd_levelinfo;
 
 #define cdd_push(node, bound)            \
@@ -448,12 +497,62 @@ int32_t cdd_error(int32_t error);
 extern ddNode* cdd_upper_from_level(int32_t, raw_t);
 extern ddNode* cdd_interval_from_level(int32_t, raw_t, raw_t);
 
+/**
+ * Find the first index from \a from to \a last at which the bound in
+ * \a bnd is at least \a target. The bound at \a last must be at least
+ * \a target. The search gallops from \a from, so it takes time
+ * logarithmic in the distance to the index found rather than in the
+ * number of bounds, and compares the final few bounds with vector
+ * instructions where the processor has them.
+ * @param bnd the bounds of a CDD node
+ * @param from the index to start from
+ * @param last the index of the last bound
+ * @param target an upper bound
+ * @return the first index with a bound of at least \a target
+ */
+extern int32_t cdd_bnd_seek(const raw_t* bnd, int32_t from, int32_t last, raw_t target);
+
+/**
+ * Find for each of \a n targets the first index at which the bound in
+ * \a bnd is at least the target, as cdd_bnd_seek() from index 0 would.
+ * The bound at \a last must be at least every target. Short bound
+ * arrays are compared against several targets at a time with vector
+ * instructions where the processor has them. \a idx may be \a targets.
+ * @param bnd the bounds of a CDD node
+ * @param last the index of the last bound
+ * @param targets the \a n upper bounds
+ * @param idx the \a n indices found
+ * @param n the number of targets
+ */
+extern void cdd_bnd_seek_n(const raw_t* bnd, int32_t last, const raw_t* targets, int32_t* idx, size_t n);
+
+/**
+ * Runs the automatic reordering if it is due. Called on entry to
+ * the top level operations, and does nothing while the reference
+ * stack is in use or a section holds the level order.
+ * @see cdd_autoreorder
+ */
+extern void cdd_reorder_point();
+
+/**
+ * Starts a section that relies on the current level order, such as
+ * a walk over the nodes of a diagram that performs operations on
+ * the way. Automatic reordering waits until every section has ended
+ * with \c cdd_reorder_release().
+ */
+extern void cdd_reorder_hold();
+
+/**
+ * Ends a section started with \c cdd_reorder_hold().
+ */
+extern void cdd_reorder_release();
+
 /**
  * Initialise operator cache.
- * @param cachsize size of caches.
+ * @param options the sizes of the caches.
  * @return 0 if successful, an error code otherwise
  */
-int32_t cdd_operator_init(size_t);
+int32_t cdd_operator_init(const cdd_options* options);
 
 /**
  * Releases memory allocated by \c cdd_operator_init().
@@ -461,17 +560,89 @@ int32_t cdd_operator_init(size_t);
 void cdd_operator_done();
 
 /**
- * Clears all operator caches.
+ * Clears all operator caches, and the tables that depend on the
+ * order of the levels.
  * @see CddCache_reset()
  */
 void cdd_operator_reset();
 
+/**
+ * Copies the counters of the operator caches.
+ * @param stats the statistics to fill in
+ */
+void cdd_operator_stats(cdd_stats* stats);
+
+/**
+ * Resets the counters of the operator caches.
+ */
+void cdd_operator_reset_stats();
+
 /**
  * Flushes all operator caches.
  * @see CddCache_flush()
  */
 void cdd_operator_flush();
 
+/**
+ * @name Tracing
+ * With \c CDD_TRACE the top level operations, garbage collections and
+ * rehashes are recorded in the ring buffer of \c cdd_trace_start(),
+ * otherwise the macros expand to nothing. An operation started while
+ * another one is in progress is part of the outer one and is not
+ * recorded on its own.
+ * @{
+ */
+#ifdef CDD_TRACE
+/** An operation in progress, see \c CDD_TRACE_BEGIN(). */
+typedef struct
+{
+    int64_t start;  ///< Start time in ns, or -1 when not recorded
+    int32_t left;   ///< Number of nodes of the first operand
+    int32_t right;  ///< Number of nodes of the second operand
+} cdd_trace_span;
+
+/** Returns the time of a monotonic clock in ns. */
+int64_t cdd_trace_now();
+
+/**
+ * Starts an operation on \a l and \a r, either of which may be NULL.
+ * Must be matched by \c cdd_trace_end().
+ */
+void cdd_trace_begin(cdd_trace_span* span, ddNode* l, ddNode* r);
+
+/**
+ * Ends an operation started with \c cdd_trace_begin() and records it
+ * as \a name with the operator \a op (-1 if none) and the result \a res.
+ */
+void cdd_trace_end(cdd_trace_span* span, const char* name, int32_t op, ddNode* res);
+
+/** Records a garbage collection of a node manager started at \a start. */
+void cdd_trace_gbc(int64_t start, int32_t nodesize, int32_t freed, int32_t alive);
+
+/** Records a rehash of the subtable of \a level started at \a start. */
+void cdd_trace_rehash(int64_t start, int32_t level, int32_t buckets, int32_t keys);
+
+/** Releases the ring buffer. */
+void cdd_trace_done();
+
+#define CDD_TRACE_BEGIN(span, l, r) \
+    cdd_trace_span span;            \
+    cdd_trace_begin(&span, l, r)
+#define CDD_TRACE_END(span, name, op, res)        cdd_trace_end(&span, name, op, res)
+#define CDD_TRACE_CLOCK(t)                        int64_t t = cdd_trace_now()
+#define CDD_TRACE_COUNT(c, n)                     int32_t c = (n)
+#define CDD_TRACE_GBC(t, nodesize, freed, alive)  cdd_trace_gbc(t, nodesize, freed, alive)
+#define CDD_TRACE_REHASH(t, level, buckets, keys) cdd_trace_rehash(t, level, buckets, keys)
+#else
+#define CDD_TRACE_BEGIN(span, l, r)
+#define CDD_TRACE_END(span, name, op, res)
+#define CDD_TRACE_CLOCK(t)
+#define CDD_TRACE_COUNT(c, n)
+#define CDD_TRACE_GBC(t, nodesize, freed, alive)
+#define CDD_TRACE_REHASH(t, level, buckets, keys)
+#endif
+/** @} */
+
 /**
  * @name CDD Iterator
  * @{
@@ -480,15 +651,26 @@ typedef struct
 {
     raw_t low;
     uintptr_t neg;
-    Elem* p;
+    const raw_t* bnd;
+    ddNode** child;
 } cdd_iterator;
 
-#define cdd_it_init(it, node) (it).low = -INF, (it).neg = cdd_mask(node), (it).p = cdd_node(node)->elem
-#define cdd_it_lower(it)      ((it).low)
-#define cdd_it_child(it)      (cdd_neg_cond((it).p->child, (it).neg))
-#define cdd_it_upper(it)      ((it).p->bnd)
-#define cdd_it_atend(it)      ((it).low == INF)
-#define cdd_it_next(it)       (it).low = cdd_it_upper(it), (it).p++
+#define cdd_it_init(it, node)                                                                             \
+    (it).low = -INF, (it).neg = cdd_mask(node), (it).bnd = cdd_node_bnd(node), (it).child = cdd_node_child(node)
+#define cdd_it_lower(it) ((it).low)
+#define cdd_it_child(it) (cdd_neg_cond(*(it).child, (it).neg))
+#define cdd_it_upper(it) (*(it).bnd)
+#define cdd_it_atend(it) ((it).low == INF)
+#define cdd_it_next(it)  (it).low = cdd_it_upper(it), (it).bnd++, (it).child++
+
+/** Returns the number of children of a CDD node \a node */
+#define cdd_node_len(node) ((int32_t)cdd_node(node)->len)
+
+/** Returns the array of upper bounds of a CDD node \a node */
+#define cdd_node_bnd(node) (cdd_node(node)->bnd)
+
+/** Returns the array of children of a CDD node \a node */
+#define cdd_node_child(node) ((ddNode**)((char*)cdd_node(node)->bnd + cdd_bnd_span(cdd_node(node)->len)))
 
 /** Returns the low child of a BDD node \a node */
 #define bdd_low(node) (cdd_neg_cond(bdd_node(node)->low, cdd_mask(node)))
@@ -27,6 +27,7 @@ int CddCache_init(CddCache* cache, size_t size)
         cache->table[n].b = NULL;
     }
     cache->tablesize = size;
+    cache->lookups = cache->hits = cache->overwrites = 0;
 
     return 0;
 }
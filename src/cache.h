@@ -29,6 +29,9 @@ typedef struct
 {
     CddCacheData* table; /**< The hash table */
     size_t tablesize;    /**< The size of the hash table */
+    int64_t lookups;     /**< Number of lookups */
+    int64_t hits;        /**< Number of lookups finding the result */
+    int64_t overwrites;  /**< Number of results replacing another one */
 } CddCache;
 
 /**
@@ -70,7 +73,30 @@ extern void CddCache_flush(CddCache* cache);
  * @param hash A 32-bit hash value
  * @return The entry for this hash value
  */
-#define CddCache_lookup(cache, hash) (&(cache)->table[(hash) % (cache)->tablesize])
+#define CddCache_lookup(cache, hash) ((cache)->lookups++, CddCache_entry(cache, hash))
+
+/**
+ * Returns the entry in the cache for the given hash value like \c
+ * CddCache_lookup(), but without counting a lookup.
+ * @param cache A cache structure
+ * @param hash A 32-bit hash value
+ * @return The entry for this hash value
+ */
+#define CddCache_entry(cache, hash) (&(cache)->table[(hash) % (cache)->tablesize])
+
+/**
+ * Counts a lookup finding the result.
+ * @param cache A cache structure
+ */
+#define CddCache_hit(cache) ((cache)->hits++)
+
+/**
+ * Counts a result being stored in an entry, which overwrites the entry
+ * if it is in use.
+ * @param cache A cache structure
+ * @param arg The first argument of the entry, NULL if unused
+ */
+#define CddCache_overwrite(cache, arg) ((cache)->overwrites += (arg) != NULL)
 
 /**
  * Returns the size of the hash table of a cache.
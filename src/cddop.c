@@ -35,19 +35,22 @@
 #define P1 12582917
 #define P2 4256249
 
-#define COMPLHASH(r, op) (cdd_pair((uintptr_t)(r), (op)))
+/* Cache hashes are computed from node keys in 32 bit arithmetic, so
+ * they do not depend on node addresses or the word size. */
+#define COMPLHASH(r, op) (cdd_pair(cdd_node_key(r), (uint32_t)(op)))
 // #define APPLYHASH(l,r,op)    (cdd_triple((unsigned int)(l), (unsigned int)(r),(op)))
-#define APPLYHASH(l, r, op) ((((uintptr_t)(op) + (uintptr_t)(l)) * P1 + (uintptr_t)(r)) * P2)
-#define EXISTHASH(l)        ((uintptr_t)(l))
-#define REPLACEHASH(r)      ((uintptr_t)r)
+#define APPLYHASH(l, r, op) ((((uint32_t)(op) + cdd_node_key(l)) * P1 + cdd_node_key(r)) * P2)
+#define EXISTHASH(l)        (cdd_node_key(l))
+#define REPLACEHASH(r)      (cdd_node_key(r))
 
 #ifdef RELAXCACHE
-#define RELAXHASH(n, l, c1, c2, u) (cdd_triple((uintptr_t)(node), cdd_pair((l), (c1)), cdd_pair((c2), (u))))
+#define RELAXHASH(n, l, c1, c2, u) \
+    (cdd_triple(cdd_node_key(n), cdd_pair((uint32_t)(l), (uint32_t)(c1)), cdd_pair((uint32_t)(c2), (uint32_t)(u))))
 #endif
 
 // #define cdd_and(l,r) cdd_apply_reduce((l), (r), cddop_and)
-#define cdd_and(l, r) cdd_apply((l), (r), cddop_and)
-#define cdd_xor(l, r) cdd_apply((l), (r), cddop_xor)
+#define cdd_and(l, r) cdd_apply_op((l), (r), cddop_and)
+#define cdd_xor(l, r) cdd_apply_op((l), (r), cddop_xor)
 #define cdd_or(l, r)  cdd_neg(cdd_and(cdd_neg(l), cdd_neg(r)))
 
 inline static int32_t maximum(int32_t a, int32_t b) __attribute__((const));
@@ -58,8 +61,8 @@ inline static int32_t maximum(int32_t a, int32_t b) { return a > b ? a : b; }
 inline static int32_t minimum(int32_t a, int32_t b) { return a < b ? a : b; }
 
 #ifdef MULTI_TERMINAL
-#define IS_TRUE(node)  cdd_eval_true(node)
-#define IS_FALSE(node) cdd_eval_false(node)
+#define IS_TRUE(node)  ((node) == cddtrue || (cdd_is_extra_terminal(node) && !cdd_mask(node)))
+#define IS_FALSE(node) ((node) == cddfalse || (cdd_is_extra_terminal(node) && cdd_mask(node)))
 #else
 #define IS_TRUE(node)  ((node) == cddtrue)
 #define IS_FALSE(node) ((node) == cddfalse)
@@ -69,6 +72,7 @@ inline static int32_t minimum(int32_t a, int32_t b) { return a < b ? a : b; }
 static CddCache applycache; /* Cache for apply results */
 static CddCache quantcache;
 static CddCache replacecache;
+static CddCache andexistcache; /* Cache for cdd_and_exist() results */
 #ifdef RELAXCACHE
 static CddRelaxCache relaxcache;
 #endif
@@ -79,28 +83,236 @@ static int32_t opid;
 void cdd2Dot(char* fname, ddNode* node, char* name);
 
 /*=== INTERNAL PROTOTYPES ==============================================*/
-static int32_t cdd_contains_rec(ddNode*, raw_t*, uint32_t dim);
+static void cdd_contains_clear(void);
+static void cdd_eval_clear(void);
+static void cdd_parts_clear(void);
+static void cdd_contains_many_rec(ddNode*, int32_t, const int32_t*, const raw_t* const*, size_t, uint32_t, int32_t*);
+static ddNode* cdd_apply_op(ddNode*, ddNode*, int32_t);
 static ddNode* cdd_apply_rec(ddNode*, ddNode*);
 #ifdef EX
 static ddNode* cdd_exist_rec(ddNode* node, int32_t*, int32_t*, int32_t, int32_t, raw_t*);
+static ddNode* cdd_exist_bool_rec(ddNode*, char*, int32_t);
+static void cdd_drop_parts(ddNode**, size_t);
 #else
 static ddNode* cdd_exist_rec(ddNode*, int32_t*, ddNode*);
 #endif
 static ddNode* cdd_replace_rec(ddNode*, int32_t*, int32_t*);
 
-int32_t cdd_operator_init(size_t cachesize)
+/* Registry of interned variable sets. The variables quantified by
+ * cdd_exist() and the substitution of cdd_replace() are mapped to a
+ * stable operation id, so that cache entries of earlier calls with the
+ * same variables can be reused. Ids are drawn from opid and thus never
+ * collide with the ids of other operations.
+ */
+typedef struct signature_
+{
+    struct signature_* next;
+    uintptr_t hash;
+    int32_t id;
+    int32_t len;
+    int32_t key[];
+} Signature;
+
+#define SIGNATURE_BUCKETS 256  /* Size of the signature hash table */
+#define SIGNATURE_MAX     4096 /* Max. number of interned signatures */
+
+static Signature* signatures[SIGNATURE_BUCKETS];
+static int32_t signaturecnt;
+
+static void cdd_signature_clear()
+{
+    Signature* sig;
+    int32_t i;
+    for (i = 0; i < SIGNATURE_BUCKETS; i++) {
+        while (signatures[i] != NULL) {
+            sig = signatures[i];
+            signatures[i] = sig->next;
+            free(sig);
+        }
+    }
+    signaturecnt = 0;
+}
+
+/* Returns the operation id of the signature \a key of length \a len,
+ * interning it if it has not been seen before.
+ */
+static int32_t cdd_signature_id(const int32_t* key, int32_t len)
+{
+    Signature* sig;
+    uintptr_t hash = len;
+    int32_t i;
+
+    for (i = 0; i < len; i++) {
+        hash = cdd_pair(hash, (uintptr_t)(uint32_t)key[i]);
+    }
+    for (sig = signatures[hash % SIGNATURE_BUCKETS]; sig != NULL; sig = sig->next) {
+        if (sig->hash == hash && sig->len == len && memcmp(sig->key, key, len * sizeof(int32_t)) == 0) {
+            return sig->id;
+        }
+    }
+
+    if (signaturecnt == SIGNATURE_MAX) {
+        cdd_signature_clear();
+    }
+    sig = malloc(sizeof(Signature) + len * sizeof(int32_t));
+    if (sig == NULL) {
+        return ++opid;
+    }
+    sig->hash = hash;
+    sig->id = ++opid;
+    sig->len = len;
+    memcpy(sig->key, key, len * sizeof(int32_t));
+    sig->next = signatures[hash % SIGNATURE_BUCKETS];
+    signatures[hash % SIGNATURE_BUCKETS] = sig;
+    signaturecnt++;
+    return sig->id;
+}
+
+/* Scratch space of the signatures. boollevels lists the BDD levels in
+ * order and is rebuilt when levels are added; reordering only swaps
+ * levels of the same type, so the list stays valid. boolflags flags
+ * the levels quantified by the running cdd_exist() or cdd_and_exist()
+ * and is all zero between calls.
+ */
+static int32_t* boollevels;
+static int32_t boollevelsof; /* cdd_levelcnt when boollevels was built */
+static int32_t* sigkey;
+static size_t sigcapacity;
+static char* boolflags;
+static int32_t boolflagcapacity;
+
+static void cdd_signature_scratch_clear()
+{
+    free(boollevels);
+    free(sigkey);
+    free(boolflags);
+    boollevels = sigkey = NULL;
+    boolflags = NULL;
+    boollevelsof = boolflagcapacity = 0;
+    sigcapacity = 0;
+}
+
+/* Returns room for a signature of \a n entries, or NULL. */
+static int32_t* cdd_signature_key(size_t n)
+{
+    if (sigcapacity < n) {
+        free(sigkey);
+        sigkey = malloc(n * sizeof(int32_t));
+        if (sigkey == NULL) {
+            sigcapacity = 0;
+            cdd_error(CDD_MEMORY);
+            return NULL;
+        }
+        sigcapacity = n;
+    }
+    return sigkey;
+}
+
+/* Returns the cdd_varnum BDD levels in order, or NULL. */
+static int32_t* cdd_bool_levels()
+{
+    int32_t i, n;
+
+    if (boollevelsof != cdd_levelcnt) {
+        free(boollevels);
+        boollevels = malloc((cdd_varnum + 1) * sizeof(int32_t));
+        if (boollevels == NULL) {
+            boollevelsof = 0;
+            cdd_error(CDD_MEMORY);
+            return NULL;
+        }
+        for (i = n = 0; i < cdd_levelcnt; i++) {
+            if (cdd_levelinfo[i].type == TYPE_BDD) {
+                boollevels[n++] = i;
+            }
+        }
+        boollevelsof = cdd_levelcnt;
+    }
+    return boollevels;
+}
+
+/* Returns the flags of the levels with the \a n levels in \a levels
+ * set, or NULL. cdd_bool_flags_clear() must be called with the same
+ * levels afterwards.
+ */
+static char* cdd_bool_flags(const int32_t* levels, int32_t n)
+{
+    int32_t i;
+
+    if (boolflagcapacity < cdd_levelcnt) {
+        free(boolflags);
+        boolflags = calloc(cdd_levelcnt, sizeof(char));
+        if (boolflags == NULL) {
+            boolflagcapacity = 0;
+            cdd_error(CDD_MEMORY);
+            return NULL;
+        }
+        boolflagcapacity = cdd_levelcnt;
+    }
+    for (i = 0; i < n; i++) {
+        boolflags[levels[i]] = 1;
+    }
+    return boolflags;
+}
+
+static void cdd_bool_flags_clear(const int32_t* levels, int32_t n)
+{
+    int32_t i;
+
+    for (i = 0; i < n; i++) {
+        boolflags[levels[i]] = 0;
+    }
+}
+
+static int int32_compare(const void* a, const void* b)
+{
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Tables of cdd_remove_negative(), built by cdd_nonneg_init() */
+static int32_t nonneg_clocknum; /* Number of clocks the tables are built for */
+static int32_t nonneg_cnt;      /* Number of x_i - x_0 levels */
+static int32_t* nonneg_levels;  /* The x_i - x_0 levels in increasing order */
+static ddNode** nonneg_suffix;  /* x_i >= 0 for the levels from nonneg_levels[k] on */
+
+/* Frees the tables of cdd_remove_negative(). The diagrams are only
+ * dereferenced if \a deref is set, as the nodes are already gone when
+ * the package is shut down.
+ */
+static void cdd_nonneg_clear(int32_t deref)
+{
+    int32_t k;
+    if (deref && nonneg_suffix != NULL) {
+        for (k = 0; k < nonneg_cnt; k++) {
+            cdd_rec_deref(nonneg_suffix[k]);
+        }
+    }
+    free(nonneg_levels);
+    free(nonneg_suffix);
+    nonneg_levels = NULL;
+    nonneg_suffix = NULL;
+    nonneg_clocknum = 0;
+    nonneg_cnt = 0;
+}
+
+int32_t cdd_operator_init(const cdd_options* options)
 {
-    if (CddCache_init(&applycache, cachesize) < 0) {
+    if (CddCache_init(&applycache, options->apply_cache) < 0) {
+        return cdd_error(CDD_MEMORY);
+    }
+    if (CddCache_init(&quantcache, options->quant_cache) < 0) {
         return cdd_error(CDD_MEMORY);
     }
-    if (CddCache_init(&quantcache, cachesize) < 0) {
+    if (CddCache_init(&replacecache, options->replace_cache) < 0) {
         return cdd_error(CDD_MEMORY);
     }
-    if (CddCache_init(&replacecache, cachesize) < 0) {
+    if (CddCache_init(&andexistcache, options->and_exist_cache) < 0) {
         return cdd_error(CDD_MEMORY);
     }
 #ifdef RELAXCACHE
-    if (CddRelaxCache_init(&relaxcache, cachesize) < 0) {
+    if (CddRelaxCache_init(&relaxcache, options->relax_cache) < 0) {
         return cdd_error(CDD_MEMORY);
     }
 #endif
@@ -113,9 +325,16 @@ void cdd_operator_done()
     CddCache_done(&applycache);
     CddCache_done(&quantcache);
     CddCache_done(&replacecache);
+    CddCache_done(&andexistcache);
 #ifdef RELAXCACHE
     CddRelaxCache_done(&relaxcache);
 #endif
+    cdd_signature_clear();
+    cdd_signature_scratch_clear();
+    cdd_parts_clear();
+    cdd_nonneg_clear(0);
+    cdd_contains_clear();
+    cdd_eval_clear();
 }
 
 void cdd_operator_reset()
@@ -123,8 +342,46 @@ void cdd_operator_reset()
     CddCache_reset(&applycache);
     CddCache_reset(&quantcache);
     CddCache_reset(&replacecache);
+    CddCache_reset(&andexistcache);
 #ifdef RELAXCACHE
     CddRelaxCache_reset(&relaxcache);
+#endif
+    // The x_i - x_0 levels may have been reordered
+    cdd_nonneg_clear(1);
+}
+
+static void cdd_cache_stats_copy(cdd_cache_stats* s, const CddCache* cache)
+{
+    s->size = cache->tablesize;
+    s->lookups = cache->lookups;
+    s->hits = cache->hits;
+    s->overwrites = cache->overwrites;
+}
+
+void cdd_operator_stats(cdd_stats* stats)
+{
+    cdd_cache_stats_copy(&stats->apply, &applycache);
+    cdd_cache_stats_copy(&stats->quant, &quantcache);
+    cdd_cache_stats_copy(&stats->replace, &replacecache);
+    cdd_cache_stats_copy(&stats->and_exist, &andexistcache);
+#ifdef RELAXCACHE
+    stats->relax.size = relaxcache.tablesize;
+    stats->relax.lookups = relaxcache.lookups;
+    stats->relax.hits = relaxcache.hits;
+    stats->relax.overwrites = relaxcache.overwrites;
+#else
+    memset(&stats->relax, 0, sizeof(stats->relax));
+#endif
+}
+
+void cdd_operator_reset_stats()
+{
+    applycache.lookups = applycache.hits = applycache.overwrites = 0;
+    quantcache.lookups = quantcache.hits = quantcache.overwrites = 0;
+    replacecache.lookups = replacecache.hits = replacecache.overwrites = 0;
+    andexistcache.lookups = andexistcache.hits = andexistcache.overwrites = 0;
+#ifdef RELAXCACHE
+    relaxcache.lookups = relaxcache.hits = relaxcache.overwrites = 0;
 #endif
 }
 
@@ -133,20 +390,31 @@ void cdd_operator_flush()
     CddCache_flush(&applycache);
     CddCache_flush(&quantcache);
     CddCache_flush(&replacecache);
+    CddCache_flush(&andexistcache);
 #ifdef RELAXCACHE
     CddRelaxCache_reset(&relaxcache);
 #endif
 }
 
 ddNode* cdd_apply(ddNode* l, ddNode* h, int32_t op)
+{
+    cdd_reorder_point();
+    return cdd_apply_op(l, h, op);
+}
+
+/* Applies \a op without reordering first, for the operations that
+ * are built from it. */
+static ddNode* cdd_apply_op(ddNode* l, ddNode* h, int32_t op)
 {
     ddNode* res;
+    CDD_TRACE_BEGIN(span, l, h);
     applyop = op;
     res = cdd_apply_rec(l, h);
     if (cdd_errorcond) {
         cdd_error(cdd_errorcond);
-        return NULL;
+        res = NULL;
     }
+    CDD_TRACE_END(span, "cdd_apply", op, res);
     return res;
 }
 
@@ -157,16 +425,19 @@ static ddNode* cdd_apply_rec(ddNode* l, ddNode* r)
     int32_t rmask;
     int32_t mask;
     Elem* top;
-    Elem* lp;
-    Elem* rp;
     Elem* first;
+    const raw_t* lb;
+    const raw_t* rb;
+    ddNode** lc;
+    ddNode** rc;
+    int32_t li, ri, llast, rlast;
     ddNode* ll;
     ddNode* lh;
     ddNode* rl;
     ddNode* rh;
     ddNode* n;
     ddNode* prev;
-    raw_t bnd;
+    raw_t bnd, inf = INF;
 
     /* Back off in case of error */
     if (cdd_errorcond) {
@@ -209,7 +480,7 @@ static ddNode* cdd_apply_rec(ddNode* l, ddNode* r)
     }
 
     /* The operation is symmetric; normalise for better cache performance */
-    if (l > r) {
+    if (cdd_node_key(l) > cdd_node_key(r)) {
         n = l;
         l = r;
         r = n;
@@ -233,6 +504,7 @@ static ddNode* cdd_apply_rec(ddNode* l, ddNode* r)
     //    fprintf(stderr, "%u\n", APPLYHASH(l, r, applyop) % 10000);
     entry = CddCache_lookup(&applycache, APPLYHASH(l, r, applyop));
     if (entry->a == l && entry->b == r && entry->c == applyop) {
+        CddCache_hit(&applycache);
         if (cdd_rglr(entry->res)->ref == 0) {
             cdd_reclaim(entry->res);
         }
@@ -245,22 +517,29 @@ static ddNode* cdd_apply_rec(ddNode* l, ddNode* r)
     l = cdd_rglr(l);
     r = cdd_rglr(r);
 
-    switch (cdd_levelinfo[minimum(l->level, r->level)].type) {
+    switch (cdd_node_type(l->level <= r->level ? l : r)) {
     case TYPE_CDD:
-        /* Prepare for recursion */
+        /* Prepare for recursion: a node at a later level is a single
+         * interval covering all values */
         top = cdd_refstacktop;
         if (l->level <= r->level) {
-            lp = cdd_node(l)->elem;
+            lb = cdd_node_bnd(l);
+            lc = cdd_node_child(l);
+            llast = cdd_node_len(l) - 1;
         } else {
-            lp = cdd_refstacktop;
-            cdd_push(l, INF);
+            lb = &inf;
+            lc = &l;
+            llast = 0;
         }
 
         if (l->level >= r->level) {
-            rp = cdd_node(r)->elem;
+            rb = cdd_node_bnd(r);
+            rc = cdd_node_child(r);
+            rlast = cdd_node_len(r) - 1;
         } else {
-            rp = cdd_refstacktop;
-            cdd_push(r, INF);
+            rb = &inf;
+            rc = &r;
+            rlast = 0;
         }
 
         /*
@@ -270,22 +549,37 @@ static ddNode* cdd_apply_rec(ddNode* l, ddNode* r)
         first = cdd_refstacktop;
 
         /* Do first recursion - check whether first edge is negated */
-        prev = cdd_apply_rec(cdd_neg_cond(lp->child, lmask), cdd_neg_cond(rp->child, rmask));
+        li = ri = 0;
+        prev = cdd_apply_rec(cdd_neg_cond(lc[0], lmask), cdd_neg_cond(rc[0], rmask));
         cdd_ref(prev);
         mask = cdd_mask(prev);
-        bnd = minimum(lp->bnd, rp->bnd);
+        n = prev;
 
         /* Continue */
-        while (bnd < INF) {
-            lp += (lp->bnd == bnd);
-            rp += (rp->bnd == bnd);
-            n = cdd_apply_rec(cdd_neg_cond(lp->child, lmask), cdd_neg_cond(rp->child, rmask));
+        for (;;) {
+            /* A false child of one side makes the conjunction false
+             * for its whole interval, so jump over the children of the
+             * other side inside it.
+             */
+            if (n == cddfalse && applyop == cddop_and) {
+                if (lc[li] == cdd_neg_cond(cddfalse, lmask) && rb[ri] < lb[li]) {
+                    ri = cdd_bnd_seek(rb, ri, rlast, lb[li]);
+                } else if (rc[ri] == cdd_neg_cond(cddfalse, rmask) && lb[li] < rb[ri]) {
+                    li = cdd_bnd_seek(lb, li, llast, rb[ri]);
+                }
+            }
+            bnd = minimum(lb[li], rb[ri]);
+            if (bnd == INF) {
+                break;
+            }
+            li += (lb[li] == bnd);
+            ri += (rb[ri] == bnd);
+            n = cdd_apply_rec(cdd_neg_cond(lc[li], lmask), cdd_neg_cond(rc[ri], rmask));
             if (n != prev) {
                 cdd_push(cdd_neg_cond(prev, mask), bnd);
                 prev = n;
                 cdd_ref(prev);
             }
-            bnd = minimum(lp->bnd, rp->bnd);
         }
         cdd_push(cdd_neg_cond(prev, mask), INF);
 
@@ -324,6 +618,7 @@ static ddNode* cdd_apply_rec(ddNode* l, ddNode* r)
     }
 
     /* Update cache entry */
+    CddCache_overwrite(&applycache, entry->a);
     entry->a = cdd_neg_cond(l, lmask);
     entry->b = cdd_neg_cond(r, rmask);
     entry->c = applyop;
@@ -355,64 +650,477 @@ ddNode* cdd_ite(ddNode* f, ddNode* g, ddNode* h)
     return f;
 }
 
+/* Combines k diagrams by pairwise conjunction in a balanced reduction
+ * tree. Each operand thus takes part in O(log k) applications on
+ * diagrams of comparable size, as opposed to O(k) applications on an
+ * ever growing accumulator. With mask set the operands and the result
+ * are negated, i.e. the disjunction is computed (De Morgan).
+ */
+static ddNode* cdd_apply_n(ddNode** parts, size_t k, int32_t mask)
+{
+    ddNode** work;
+    ddNode** src;
+    ddNode* res;
+    size_t i;
+    size_t n;
+
+    if (k == 0) {
+        return cdd_neg_cond(cddtrue, mask);
+    }
+    if (k == 1) {
+        return parts[0];
+    }
+
+    work = malloc(((k + 1) / 2) * sizeof(ddNode*));
+    if (work == NULL) {
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+
+    /* The first round reads the operands, later rounds the work
+     * array. Intermediate results are referenced since the next
+     * application may trigger a garbage collection.
+     */
+    src = parts;
+    do {
+        n = 0;
+        for (i = 0; i + 1 < k; i += 2) {
+            res = cdd_apply_op(cdd_neg_cond(src[i], mask), cdd_neg_cond(src[i + 1], mask), cddop_and);
+            if (res == NULL) {
+                while (n > 0) {
+                    cdd_rec_deref(work[--n]);
+                }
+                if (src == work) {
+                    for (; i < k; i++) {
+                        cdd_rec_deref(work[i]);
+                    }
+                }
+                free(work);
+                return NULL;
+            }
+            res = cdd_neg_cond(res, mask);
+            cdd_ref(res);
+            if (src == work) {
+                cdd_rec_deref(work[i]);
+                cdd_rec_deref(work[i + 1]);
+            }
+            work[n++] = res;
+        }
+        if (i < k) {
+            if (src != work) {
+                cdd_ref(src[i]);
+            }
+            work[n++] = src[i];
+        }
+        src = work;
+        k = n;
+    } while (k > 1);
+
+    res = work[0];
+    free(work);
+    cdd_deref(res);
+    return res;
+}
+
+ddNode* cdd_and_n(ddNode** parts, size_t k) { return cdd_apply_n(parts, k, 0); }
+
+ddNode* cdd_or_n(ddNode** parts, size_t k) { return cdd_apply_n(parts, k, 1); }
+
+/* Work space of cdd_contains_many_rec(), one entry per depth of the
+ * recursion. It is kept between calls, so that containment checks do
+ * not allocate once it has grown large enough.
+ */
+typedef struct
+{
+    size_t capacity;     /* Number of queries the entry has room for */
+    size_t zonesize;     /* Number of raw_t in zones */
+    int32_t* ids;        /* Queries passed to the next depth */
+    const raw_t** dbms;  /* Their dbms */
+    raw_t* zones;        /* Constrained copies of the dbms */
+} ContainsFrame;
+
+static ContainsFrame* containsframes;
+static int32_t containsdepth;
+
+static void cdd_contains_clear()
+{
+    int32_t i;
+    for (i = 0; i < containsdepth; i++) {
+        free(containsframes[i].ids);
+        free((void*)containsframes[i].dbms);
+        free(containsframes[i].zones);
+    }
+    free(containsframes);
+    containsframes = NULL;
+    containsdepth = 0;
+}
+
+/* Makes room for \a n queries of dimension \a dim at all depths a
+ * walk over the current levels can reach.
+ */
+static int32_t cdd_contains_reserve(size_t n, uint32_t dim)
+{
+    ContainsFrame* frames;
+    ContainsFrame* frame;
+    int32_t depth = cdd_levelcnt + 2;
+    int32_t i;
+
+    if (depth > containsdepth) {
+        frames = realloc(containsframes, depth * sizeof(ContainsFrame));
+        if (frames == NULL) {
+            return cdd_error(CDD_MEMORY);
+        }
+        memset(frames + containsdepth, 0, (depth - containsdepth) * sizeof(ContainsFrame));
+        containsframes = frames;
+        containsdepth = depth;
+    }
+    for (i = 0; i < depth; i++) {
+        frame = containsframes + i;
+        if (frame->capacity < n) {
+            free(frame->ids);
+            free((void*)frame->dbms);
+            frame->ids = malloc(n * sizeof(int32_t));
+            frame->dbms = malloc(n * sizeof(raw_t*));
+            frame->capacity = n;
+            if (frame->ids == NULL || frame->dbms == NULL) {
+                frame->capacity = 0;
+                return cdd_error(CDD_MEMORY);
+            }
+        }
+        if (frame->zonesize < n * dim * dim) {
+            free(frame->zones);
+            frame->zones = malloc(n * dim * dim * sizeof(raw_t));
+            frame->zonesize = n * dim * dim;
+            if (frame->zones == NULL) {
+                frame->zonesize = 0;
+                return cdd_error(CDD_MEMORY);
+            }
+        }
+    }
+    return 0;
+}
+
 int32_t cdd_contains(ddNode* node, raw_t* dbm, uint32_t dim)
 {
-    assert(dbm_isValid(dbm, dim));
-    return cdd_contains_rec(node, dbm, dim);
+    int32_t result;
+    const raw_t* dbms[1] = {dbm};
+    cdd_contains_many(node, dbms, 1, dim, &result);
+    return result;
 }
 
-static int32_t cdd_contains_rec(ddNode* node, raw_t* d, uint32_t dim)
+void cdd_contains_many(ddNode* node, const raw_t* const* dbms, size_t n, uint32_t dim, int32_t* results)
 {
-    raw_t* tmp;
+    size_t k;
+
+    if (cdd_contains_reserve(n, dim) < 0) {
+        for (k = 0; k < n; k++) {
+            results[k] = 0;
+        }
+        return;
+    }
+    for (k = 0; k < n; k++) {
+        assert(dbm_isValid(dbms[k], dim));
+        results[k] = 1;
+        containsframes[0].ids[k] = k;
+    }
+    cdd_contains_many_rec(node, 0, containsframes[0].ids, dbms, n, dim, results);
+}
+
+/* Clears the result of the \a n queries \a ids whose dbms \a dbms are
+ * not included in \a node. The queries at a node are passed down to
+ * the children they intersect, where a query entirely inside the
+ * interval of a child is passed on as it is and only the others are
+ * constrained, in the zones of the frame of the next depth.
+ */
+static void cdd_contains_many_rec(ddNode* node, int32_t depth, const int32_t* ids, const raw_t* const* dbms,
+                                  size_t n, uint32_t dim, int32_t* results)
+{
+    ContainsFrame* frame;
     cdd_iterator it;
     LevelInfo* info;
+    const raw_t* d;
+    raw_t* zone;
+    raw_t lower, upper, up, low, lowest, highest;
+    size_t k, m;
+    uint32_t i, j;
 
     /* Check termination conditions */
-    if (node == cddtrue)
-        return 1;
-    if (node == cddfalse)
-        return 0;
+    if (n == 0 || node == cddtrue)
+        return;
+    if (node == cddfalse) {
+        for (k = 0; k < n; k++) {
+            results[ids[k]] = 0;
+        }
+        return;
+    }
 
 #ifdef MULTI_TERMINAL
     if (cdd_is_extra_terminal(node)) {
-        return cdd_mask(node) ? 0 : 1;
+        if (cdd_mask(node)) {
+            for (k = 0; k < n; k++) {
+                results[ids[k]] = 0;
+            }
+        }
+        return;
     }
 #endif
 
+    frame = containsframes + depth + 1;
     info = cdd_info(node);
-    switch (info->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         /* If the DBM has a lower dimension than the CDD, then the DBM
          * is a priori bigger than any CDD restricting these extra
          * dimensions. Thus the CDD does not contain the DBM.
          */
         if (info->clock1 >= dim || info->clock2 >= dim) {
-            return 0;
+            for (k = 0; k < n; k++) {
+                results[ids[k]] = 0;
+            }
+            return;
         }
 
-        /* Allocate space for copy */
-        tmp = malloc(dim * dim * sizeof(raw_t));
-        /* Iterate over children */
-        for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
-            if (!IS_TRUE(cdd_it_child(it))) {
-                dbm_copy(tmp, d, dim);
-                if (cdd_constrain2(tmp, dim, info->clock1, info->clock2, cdd_it_lower(it), cdd_it_upper(it)) &&
-                    !cdd_contains_rec(cdd_it_child(it), tmp, dim)) {
-                    free(tmp);
-                    return 0;
+        /* Only the children between the loosest lower and upper
+         * bounds of the queries can intersect any of them, so seek to
+         * the first of them and stop after the last.
+         */
+        i = info->clock1;
+        j = info->clock2;
+        lowest = INF;
+        highest = -INF;
+        for (k = 0; k < n; k++) {
+            lowest = minimum(lowest, bnd_u2l(dbms[k][j * dim + i]));
+            highest = maximum(highest, dbms[k][i * dim + j]);
+        }
+        cdd_it_init(it, node);
+        k = cdd_bnd_seek(it.bnd, 0, cdd_node_len(node) - 1, lowest + 1);
+        if (k > 0) {
+            it.low = it.bnd[k - 1];
+            it.bnd += k;
+            it.child += k;
+        }
+        for (; !cdd_it_atend(it) && cdd_it_lower(it) < highest; cdd_it_next(it)) {
+            if (IS_TRUE(cdd_it_child(it))) {
+                continue;
+            }
+            lower = cdd_it_lower(it);
+            upper = cdd_it_upper(it);
+            zone = frame->zones;
+            for (k = m = 0; k < n; k++) {
+                if (!results[ids[k]]) {
+                    continue;
+                }
+                d = dbms[k];
+                up = d[i * dim + j];
+                low = d[j * dim + i];
+                if (bnd_add(upper, low) < dbm_LE_ZERO || bnd_add(up, bnd_l2u(lower)) < dbm_LE_ZERO) {
+                    /* Disjoint from the interval */
+                    continue;
                 }
+                if (up > upper || low > bnd_l2u(lower)) {
+                    dbm_copy(zone, d, dim);
+                    if (!cdd_constrain2(zone, dim, i, j, lower, upper)) {
+                        continue;
+                    }
+                    d = zone;
+                    zone += dim * dim;
+                }
+                frame->ids[m] = ids[k];
+                frame->dbms[m++] = d;
             }
+            cdd_contains_many_rec(cdd_it_child(it), depth + 1, frame->ids, frame->dbms, m, dim, results);
         }
-        free(tmp);
         break;
     case TYPE_BDD:
-        if (cdd_contains_rec(bdd_node(node)->low, d, dim) | cdd_contains_rec(bdd_node(node)->high, d, dim))
+        /* Included if included in either child */
+        cdd_contains_many_rec(bdd_low(node), depth + 1, ids, dbms, n, dim, results);
+        for (k = m = 0; k < n; k++) {
+            if (!results[ids[k]]) {
+                results[ids[k]] = 1;
+                frame->ids[m] = ids[k];
+                frame->dbms[m++] = dbms[k];
+            }
+        }
+        cdd_contains_many_rec(bdd_high(node), depth + 1, frame->ids, frame->dbms, m, dim, results);
+        break;
+    }
+}
+
+/* Scratch space of cdd_eval_points(). The ids of the points and the
+ * children they go to are kept side by side, and the points at a node
+ * are reordered so that each child gets a contiguous range. A range is
+ * only reordered by the calls below the node owning it, so one array
+ * serves all depths.
+ */
+static size_t evalcapacity;
+static int32_t* evalids;
+static int32_t* evalslots;
+static int32_t* evaltmp;
+static int32_t* evalcounts;
+
+static void cdd_eval_clear()
+{
+    free(evalids);
+    free(evalcounts);
+    evalids = evalslots = evaltmp = evalcounts = NULL;
+    evalcapacity = 0;
+}
+
+static int32_t cdd_eval_reserve(size_t n)
+{
+    if (evalcounts == NULL) {
+        evalcounts = malloc((cdd_maxcddsize + 1) * sizeof(int32_t));
+        if (evalcounts == NULL) {
+            return cdd_error(CDD_MEMORY);
+        }
+    }
+    if (evalcapacity < n) {
+        free(evalids);
+        evalids = malloc(3 * n * sizeof(int32_t));
+        if (evalids == NULL) {
+            evalcapacity = 0;
+            return cdd_error(CDD_MEMORY);
+        }
+        evalslots = evalids + n;
+        evaltmp = evalslots + n;
+        evalcapacity = n;
+    }
+    return 0;
+}
+
+/* Returns the index of the child of the CDD node \a node whose
+ * interval contains the difference \a value.
+ */
+static int32_t cdd_eval_find(ddNode* node, int32_t value)
+{
+    return cdd_bnd_seek(cdd_node_bnd(node), 0, cdd_node_len(node) - 1, dbm_bound2raw(value, dbm_WEAK));
+}
+
+int32_t cdd_eval_point(ddNode* node, const int32_t* clocks, const bool* bools)
+{
+    LevelInfo* info;
+
+    for (;;) {
+        if (node == cddtrue)
             return 1;
-        else
+        if (node == cddfalse)
             return 0;
-        break;
+#ifdef MULTI_TERMINAL
+        if (cdd_is_extra_terminal(node))
+            return !cdd_mask(node);
+#endif
+        if (cdd_node_type(node) == TYPE_BDD) {
+            node = bools[cdd_level2var[cdd_rglr(node)->level]] ? bdd_high(node) : bdd_low(node);
+        } else {
+            info = cdd_info(node);
+            node = cdd_neg_cond(cdd_node_child(node)[cdd_eval_find(node, clocks[info->clock1] - clocks[info->clock2])],
+                                cdd_mask(node));
+        }
     }
-    return 1;
+}
+
+/* Evaluates the \a n points at positions \a ids of \a clocks and \a
+ * bools in \a node. \a slots is scratch space of the same range.
+ */
+static void cdd_eval_points_rec(ddNode* node, int32_t* ids, int32_t* slots, size_t n, const int32_t* const* clocks,
+                                const bool* const* bools, int32_t* results)
+{
+    LevelInfo* info;
+    ddNode* child;
+    const int32_t* v;
+    int32_t cnt, c, level, i, j, sorted;
+    size_t k, e;
+
+    if (n == 0)
+        return;
+    if (node == cddtrue || node == cddfalse) {
+        for (k = 0; k < n; k++) {
+            results[ids[k]] = node == cddtrue;
+        }
+        return;
+    }
+#ifdef MULTI_TERMINAL
+    if (cdd_is_extra_terminal(node)) {
+        for (k = 0; k < n; k++) {
+            results[ids[k]] = !cdd_mask(node);
+        }
+        return;
+    }
+#endif
+
+    /* Find the child of every point, searching the bounds of a CDD node
+     * for all the points at once */
+    info = cdd_info(node);
+    if (cdd_node_type(node) == TYPE_BDD) {
+        cnt = 2;
+        level = cdd_level2var[cdd_rglr(node)->level];
+        for (k = 0; k < n; k++) {
+            slots[k] = bools[ids[k]][level] ? 1 : 0;
+        }
+    } else {
+        cnt = cdd_node_len(node);
+        i = info->clock1;
+        j = info->clock2;
+        for (k = 0; k < n; k++) {
+            v = clocks[ids[k]];
+            slots[k] = dbm_bound2raw(v[i] - v[j], dbm_WEAK);
+        }
+        cdd_bnd_seek_n(cdd_node_bnd(node), cnt - 1, slots, slots, n);
+    }
+    sorted = 1;
+    for (k = 1; k < n; k++) {
+        sorted &= slots[k - 1] <= slots[k];
+    }
+
+    /* Group the points by child with a counting sort */
+    if (!sorted) {
+        memset(evalcounts, 0, (cnt + 1) * sizeof(int32_t));
+        for (k = 0; k < n; k++) {
+            evalcounts[slots[k] + 1]++;
+        }
+        for (c = 0; c < cnt; c++) {
+            evalcounts[c + 1] += evalcounts[c];
+        }
+        for (k = 0; k < n; k++) {
+            evaltmp[evalcounts[slots[k]]++] = ids[k];
+        }
+        memcpy(ids, evaltmp, n * sizeof(int32_t));
+        for (c = 0, k = 0; c < cnt; c++) {
+            for (; k < (size_t)evalcounts[c]; k++) {
+                slots[k] = c;
+            }
+        }
+    }
+
+    /* Descend once per child */
+    for (k = 0; k < n; k = e) {
+        c = slots[k];
+        for (e = k + 1; e < n && slots[e] == c; e++) {
+        }
+        if (cdd_node_type(node) == TYPE_BDD) {
+            child = c ? bdd_high(node) : bdd_low(node);
+        } else {
+            child = cdd_neg_cond(cdd_node_child(node)[c], cdd_mask(node));
+        }
+        cdd_eval_points_rec(child, ids + k, slots + k, e - k, clocks, bools, results);
+    }
+}
+
+void cdd_eval_points(ddNode* node, const int32_t* const* clocks, const bool* const* bools, size_t n,
+                     int32_t* results)
+{
+    size_t k;
+
+    if (cdd_eval_reserve(n) < 0) {
+        for (k = 0; k < n; k++) {
+            results[k] = 0;
+        }
+        return;
+    }
+    for (k = 0; k < n; k++) {
+        evalids[k] = k;
+    }
+    cdd_eval_points_rec(node, evalids, evalslots, n, clocks, bools, results);
 }
 
 int32_t cdd_edgecount(ddNode* node)
@@ -431,18 +1139,117 @@ int32_t cdd_edgecount(ddNode* node)
 /* Existentially quantify clocks in a CDD.
  */
 #ifdef EX
-ddNode* cdd_exist(ddNode* node, int32_t* levels_bool, int32_t* clocks, int32_t num_bool_resets,
-                  int32_t num_clock_resets)
+/* Interns the variables quantified by cdd_exist() and cdd_and_exist().
+ * The signature is the sorted current levels of the boolean variables
+ * followed by the clock flags, so any order or repetition of the
+ * variables maps to the same id. \a key needs room for \a
+ * *num_bool_resets + cdd_clocknum + 1 entries. On return its first \a
+ * *num_bool_resets entries are the distinct quantified levels, and \a
+ * clock_flags flags the quantified clocks.
+ */
+static int32_t cdd_exist_signature(int32_t* levels_bool, int32_t* clocks, int32_t* num_bool_resets,
+                                   int32_t num_clock_resets, int32_t* clock_flags, int32_t* key)
 {
     int32_t i, j;
-    raw_t removed_constraint[cdd_clocknum * cdd_clocknum];
+
+    /* The recursion and relax() look clocks up by index */
+    for (i = 0; i < cdd_clocknum; i++) {
+        clock_flags[i] = 0;
+    }
+    for (i = 0; clocks != NULL && i < num_clock_resets; i++) {
+        clock_flags[clocks[i]] = 1;
+    }
+
+    for (i = 0; i < *num_bool_resets; i++) {
+        key[i] = cdd_var2level[levels_bool[i]];
+    }
+    qsort(key, *num_bool_resets, sizeof(int32_t), int32_compare);
+    for (i = j = 0; i < *num_bool_resets; i++) {
+        if (j == 0 || key[j - 1] != key[i]) {
+            key[j++] = key[i];
+        }
+    }
+    *num_bool_resets = j;
+    key[j++] = -1;
+    for (i = 0; i < cdd_clocknum; i++) {
+        key[j++] = clock_flags[i];
+    }
+    return cdd_signature_id(key, j);
+}
+
+ddNode* cdd_exist(ddNode* node, int32_t* levels_bool, int32_t* clocks, int32_t num_bool_resets,
+                  int32_t num_clock_resets)
+{
+    CddCacheData* entry;
+    ddNode* res;
+    int32_t i, j, sig;
+    int32_t* key;
+    char* bool_flags;
+    int32_t clock_flags[cdd_clocknum];
+    raw_t removed_constraint[cdd_clocknum * cdd_clocknum];
     for (i = 0; i < cdd_clocknum; i++) {
         for (j = 0; j < cdd_clocknum; j++) {
             removed_constraint[i * cdd_clocknum + j] = INF;
         }
     }
+
+    if (levels_bool == NULL) {
+        num_bool_resets = 0;
+    }
+    key = cdd_signature_key(num_bool_resets + cdd_clocknum + 1);
+    if (key == NULL) {
+        return NULL;
+    }
+    sig = cdd_exist_signature(levels_bool, clocks, &num_bool_resets, num_clock_resets, clock_flags, key);
+
+    /* With only boolean variables to quantify the result of a node does
+     * not depend on the path to it, so the whole recursion is cached
+     * under the signature. */
+    for (i = 0; i < cdd_clocknum && !clock_flags[i]; i++)
+        ;
+    if (i == cdd_clocknum) {
+        if (num_bool_resets == 0) {
+            return node;
+        }
+        bool_flags = cdd_bool_flags(key, num_bool_resets);
+        if (bool_flags == NULL) {
+            return NULL;
+        }
+        CDD_TRACE_BEGIN(span, node, NULL);
+        i = opid;
+        opid = sig;
+        res = cdd_exist_bool_rec(node, bool_flags, key[num_bool_resets - 1]);
+        opid = i;
+        cdd_bool_flags_clear(key, num_bool_resets);
+        CDD_TRACE_END(span, "cdd_exist", -1, res);
+        return res;
+    }
+
+    /* Only the result of the whole call is reused across calls: inside
+     * the recursion the result of a node also depends on the
+     * constraints removed above it. */
+    entry = CddCache_lookup(&quantcache, cdd_pair(EXISTHASH(node), sig));
+    if (entry->a == node && entry->b == NULL && entry->c == sig) {
+        CddCache_hit(&quantcache);
+        if (cdd_rglr(entry->res)->ref == 0) {
+            cdd_reclaim(entry->res);
+        }
+        return entry->res;
+    }
+
+    CDD_TRACE_BEGIN(span, node, NULL);
     opid++;
-    return cdd_exist_rec(node, levels_bool, clocks, num_bool_resets, num_clock_resets, removed_constraint);
+    res = cdd_exist_rec(node, key, clock_flags, num_bool_resets, num_clock_resets, removed_constraint);
+    if (res != NULL) {
+        entry = CddCache_entry(&quantcache, cdd_pair(EXISTHASH(node), sig));
+        CddCache_overwrite(&quantcache, entry->a);
+        entry->a = node;
+        entry->b = NULL;
+        entry->c = sig;
+        entry->res = res;
+    }
+    CDD_TRACE_END(span, "cdd_exist", -1, res);
+    return res;
 }
 #else
 ddNode* cdd_exist(ddNode* node, int32_t* levels)
@@ -452,6 +1259,537 @@ ddNode* cdd_exist(ddNode* node, int32_t* levels)
 }
 #endif
 
+/* The variables quantified by cdd_and_exist_rec(), which are the same
+ * for the whole operation.
+ */
+typedef struct
+{
+    int32_t* levels; /* The quantified boolean levels in increasing order */
+    int32_t nbool;   /* Number of quantified boolean levels */
+    int32_t* clocks; /* Flags of the quantified clocks */
+    int32_t nclock;  /* Number of quantified clocks */
+    char* flags;     /* Flags of the quantified boolean levels */
+    int32_t sig;     /* Signature of the quantified variables */
+    raw_t* rc;       /* No constraints removed, for cdd_exist_rec() */
+} AndExist;
+
+/* Quantifies the variables of \a q in \a node alone. */
+static ddNode* cdd_and_exist_one(ddNode* node, AndExist* q)
+{
+    if (q->nclock == 0) {
+        return cdd_exist_bool_rec(node, q->flags, q->levels[q->nbool - 1]);
+    }
+    return cdd_exist_rec(node, q->levels, q->clocks, q->nbool, q->nclock, q->rc);
+}
+
+/* Builds the node of \a level from the children on the reference stack
+ * above \a top, each with the upper bound of its interval, and pops
+ * them. A child may have a level above \a level if cdd_exist_rec()
+ * added consequences to it, and is then conjoined with its interval.
+ */
+static ddNode* cdd_and_exist_node(int32_t level, Elem* top)
+{
+    ddNode** parts;
+    ddNode* res;
+    ddNode* tmp;
+    Elem* elem;
+    raw_t lower;
+    size_t n;
+    int32_t above;
+    int32_t mask;
+
+    above = 0;
+    for (elem = top; elem < cdd_refstacktop; elem++) {
+        above |= !cdd_isterminal(elem->child) && cdd_rglr(elem->child)->level <= level;
+    }
+
+    if (cdd_refstacktop - top == 1) {
+        /* A single interval covers all values */
+        res = top->child;
+        cdd_ref(res);
+    } else if (above) {
+        parts = malloc((cdd_refstacktop - top) * sizeof(ddNode*));
+        if (parts == NULL) {
+            res = NULL;
+            cdd_error(CDD_MEMORY);
+        } else {
+            n = 0;
+            lower = -INF;
+            for (elem = top; elem < cdd_refstacktop; elem++) {
+                tmp = cdd_interval_from_level(level, lower, elem->bnd);
+                cdd_ref(tmp);
+                res = cdd_and(tmp, elem->child);
+                if (res != NULL) {
+                    cdd_ref(res);
+                }
+                cdd_rec_deref(tmp);
+                if (res == NULL) {
+                    break;
+                }
+                parts[n++] = res;
+                lower = elem->bnd;
+            }
+            res = elem < cdd_refstacktop ? NULL : cdd_or_n(parts, n);
+            if (res != NULL) {
+                cdd_ref(res);
+            }
+            cdd_drop_parts(parts, n);
+        }
+    } else {
+        mask = cdd_mask(top->child);
+        for (elem = top; elem < cdd_refstacktop; elem++) {
+            elem->child = cdd_neg_cond(elem->child, mask);
+        }
+        res = cdd_make_cdd_node(level, top, cdd_refstacktop - top);
+        if (res != NULL) {
+            res = cdd_neg_cond(res, mask);
+            cdd_ref(res);
+        }
+    }
+
+    while (cdd_refstacktop > top) {
+        cdd_refstacktop--;
+        cdd_rec_deref(cdd_refstacktop->child);
+    }
+    if (res != NULL) {
+        cdd_deref(res);
+    }
+    return res;
+}
+
+/* Quantifies the variables of \a q in the conjunction of \a l and \a
+ * r. The conjunction is only built below the first level on a
+ * quantified clock, where the level is eliminated by cdd_exist_rec()
+ * and relax() exactly as for cdd_exist(). Above it the intervals of
+ * both sides are merged as in cdd_apply_rec(), and the quantified
+ * boolean levels are eliminated on the way up. No constraint has been
+ * removed above such a pair, so its result only depends on the
+ * quantified variables and is cached under their signature.
+ */
+static ddNode* cdd_and_exist_rec(ddNode* l, ddNode* r, AndExist* q)
+{
+    CddCacheData* entry;
+    LevelInfo* info;
+    ddNode* res;
+    ddNode* n;
+    ddNode* tmp1;
+    ddNode* tmp2;
+    ddNode** lc;
+    ddNode** rch;
+    const raw_t* lb;
+    const raw_t* rb;
+    Elem* top;
+    int32_t li, ri, llast, rlast;
+    int32_t lmask, rmask, level;
+    raw_t bnd, inf = INF;
+
+    if (cdd_errorcond) {
+        return NULL;
+    }
+
+    /* Termination conditions */
+    if (l == cddfalse || r == cddfalse || l == cdd_neg(r)) {
+        return cddfalse;
+    }
+    if (l == cddtrue || l == r) {
+        return cdd_and_exist_one(r, q);
+    }
+    if (r == cddtrue) {
+        return cdd_and_exist_one(l, q);
+    }
+
+    /* The operation is symmetric; normalise for better cache performance */
+    if (cdd_node_key(l) > cdd_node_key(r)) {
+        n = l;
+        l = r;
+        r = n;
+    }
+
+    if (cdd_isterminal(l) && cdd_isterminal(r)) {
+        /* Only for extra terminals, see cdd_apply_rec() */
+        return l;
+    }
+
+    entry = CddCache_lookup(&andexistcache, APPLYHASH(l, r, q->sig));
+    if (entry->a == l && entry->b == r && entry->c == q->sig) {
+        CddCache_hit(&andexistcache);
+        if (cdd_rglr(entry->res)->ref == 0) {
+            cdd_reclaim(entry->res);
+        }
+        return entry->res;
+    }
+
+    lmask = cdd_mask(l);
+    rmask = cdd_mask(r);
+    l = cdd_rglr(l);
+    r = cdd_rglr(r);
+    level = minimum(l->level, r->level);
+    info = cdd_levelinfo + level;
+
+    switch (info->type) {
+    case TYPE_CDD:
+        if (q->clocks[info->clock1] || q->clocks[info->clock2]) {
+            tmp1 = cdd_and(cdd_neg_cond(l, lmask), cdd_neg_cond(r, rmask));
+            if (tmp1 == NULL) {
+                return NULL;
+            }
+            cdd_ref(tmp1);
+            res = cdd_exist_rec(tmp1, q->levels, q->clocks, q->nbool, q->nclock, q->rc);
+            if (res != NULL) {
+                cdd_ref(res);
+            }
+            cdd_rec_deref(tmp1);
+            if (res == NULL) {
+                return NULL;
+            }
+            cdd_deref(res);
+            break;
+        }
+
+        /* A node at a later level is a single interval covering all values */
+        if (l->level == level) {
+            lb = cdd_node_bnd(l);
+            lc = cdd_node_child(l);
+            llast = cdd_node_len(l) - 1;
+        } else {
+            lb = &inf;
+            lc = &l;
+            llast = 0;
+        }
+        if (r->level == level) {
+            rb = cdd_node_bnd(r);
+            rch = cdd_node_child(r);
+            rlast = cdd_node_len(r) - 1;
+        } else {
+            rb = &inf;
+            rch = &r;
+            rlast = 0;
+        }
+
+        top = cdd_refstacktop;
+        li = ri = 0;
+        for (;;) {
+            /* A false child of one side is false for its whole
+             * interval, so jump over the children of the other side
+             * inside it. */
+            if (lc[li] == cdd_neg_cond(cddfalse, lmask) && rb[ri] < lb[li]) {
+                ri = cdd_bnd_seek(rb, ri, rlast, lb[li]);
+            } else if (rch[ri] == cdd_neg_cond(cddfalse, rmask) && lb[li] < rb[ri]) {
+                li = cdd_bnd_seek(lb, li, llast, rb[ri]);
+            }
+            bnd = minimum(lb[li], rb[ri]);
+            n = cdd_and_exist_rec(cdd_neg_cond(lc[li], lmask), cdd_neg_cond(rch[ri], rmask), q);
+            if (n == NULL) {
+                while (cdd_refstacktop > top) {
+                    cdd_refstacktop--;
+                    cdd_rec_deref(cdd_refstacktop->child);
+                }
+                return NULL;
+            }
+            /* Adjacent equal children are merged */
+            if (cdd_refstacktop > top && cdd_refstacktop[-1].child == n) {
+                cdd_refstacktop[-1].bnd = bnd;
+            } else {
+                cdd_ref(n);
+                cdd_push(n, bnd);
+            }
+            if (bnd == INF) {
+                break;
+            }
+            li += (lb[li] == bnd);
+            ri += (rb[ri] == bnd);
+        }
+
+        res = cdd_and_exist_node(level, top);
+        if (res == NULL) {
+            return NULL;
+        }
+        break;
+    case TYPE_BDD:
+        tmp1 = cdd_and_exist_rec(cdd_neg_cond(l->level == level ? bdd_node(l)->low : l, lmask),
+                                 cdd_neg_cond(r->level == level ? bdd_node(r)->low : r, rmask), q);
+        if (tmp1 == NULL) {
+            return NULL;
+        }
+        if (q->flags[level] && tmp1 == cddtrue) {
+            res = cddtrue;
+            break;
+        }
+        cdd_ref(tmp1);
+        tmp2 = cdd_and_exist_rec(cdd_neg_cond(l->level == level ? bdd_node(l)->high : l, lmask),
+                                 cdd_neg_cond(r->level == level ? bdd_node(r)->high : r, rmask), q);
+        if (tmp2 == NULL) {
+            cdd_rec_deref(tmp1);
+            return NULL;
+        }
+        cdd_ref(tmp2);
+
+        if (q->flags[level]) {
+            res = cdd_and(cdd_neg(tmp1), cdd_neg(tmp2));
+            res = res == NULL ? NULL : cdd_neg(res);
+        } else if ((cdd_isterminal(tmp1) || cdd_rglr(tmp1)->level > level) &&
+                   (cdd_isterminal(tmp2) || cdd_rglr(tmp2)->level > level)) {
+            res = cdd_make_bdd_node(level, tmp1, tmp2);
+        } else {
+            /* cdd_exist_rec() added constraints above the level */
+            n = cdd_make_bdd_node(level, cddfalse, cddtrue);
+            cdd_ref(n);
+            res = cdd_ite(n, tmp2, tmp1);
+            if (res != NULL) {
+                cdd_ref(res);
+            }
+            cdd_rec_deref(n);
+            if (res != NULL) {
+                cdd_deref(res);
+            }
+        }
+        if (res != NULL) {
+            cdd_ref(res);
+        }
+        cdd_rec_deref(tmp1);
+        cdd_rec_deref(tmp2);
+        if (res == NULL) {
+            return NULL;
+        }
+        cdd_deref(res);
+        break;
+    default: return NULL;
+    }
+
+    CddCache_overwrite(&andexistcache, entry->a);
+    entry->a = cdd_neg_cond(l, lmask);
+    entry->b = cdd_neg_cond(r, rmask);
+    entry->c = q->sig;
+    entry->res = res;
+
+    return res;
+}
+
+ddNode* cdd_and_exist(ddNode* l, ddNode* r, int32_t* levels_bool, int32_t* clocks, int32_t num_bool_resets,
+                      int32_t num_clock_resets)
+{
+    AndExist q;
+    ddNode* res;
+    int32_t i, id;
+    int32_t* key;
+    int32_t clock_flags[cdd_clocknum];
+    raw_t removed_constraint[cdd_clocknum * cdd_clocknum];
+
+    if (levels_bool == NULL) {
+        num_bool_resets = 0;
+    }
+    key = cdd_signature_key(num_bool_resets + cdd_clocknum + 1);
+    if (key == NULL) {
+        return NULL;
+    }
+    q.sig = cdd_exist_signature(levels_bool, clocks, &num_bool_resets, num_clock_resets, clock_flags, key);
+
+    q.levels = key;
+    q.nbool = num_bool_resets;
+    q.clocks = clock_flags;
+    q.nclock = 0;
+    for (i = 0; i < cdd_clocknum; i++) {
+        q.nclock += clock_flags[i];
+    }
+    if (q.nbool == 0 && q.nclock == 0) {
+        return cdd_and(l, r);
+    }
+    q.flags = cdd_bool_flags(key, q.nbool);
+    if (q.flags == NULL) {
+        return NULL;
+    }
+    q.rc = removed_constraint;
+    for (i = 0; i < cdd_clocknum * cdd_clocknum; i++) {
+        removed_constraint[i] = INF;
+    }
+
+    CDD_TRACE_BEGIN(span, l, r);
+    /* As in cdd_exist(), cdd_exist_bool_rec() reuses its results under
+     * the signature, while cdd_exist_rec() needs a fresh operation */
+    if (q.nclock == 0) {
+        id = opid;
+        opid = q.sig;
+        res = cdd_and_exist_rec(l, r, &q);
+        opid = id;
+    } else {
+        opid++;
+        res = cdd_and_exist_rec(l, r, &q);
+    }
+    cdd_bool_flags_clear(key, q.nbool);
+    if (cdd_errorcond) {
+        cdd_error(cdd_errorcond);
+        res = NULL;
+    }
+    CDD_TRACE_END(span, "cdd_and_exist", -1, res);
+    return res;
+}
+
+/* Conjoins \a node with the new values of the clocks and boolean
+ * variables of an update in one balanced conjunction.
+ */
+static ddNode* cdd_and_values(ddNode* node, int32_t* clocks, int32_t* clock_values, int32_t num_clocks,
+                              int32_t* bools, int32_t* bool_values, int32_t num_bools)
+{
+    ddNode** parts;
+    ddNode* res;
+    int32_t i;
+    int32_t n;
+
+    if (node == NULL) {
+        return NULL;
+    }
+    parts = malloc((num_clocks + num_bools + 1) * sizeof(ddNode*));
+    if (parts == NULL) {
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+    n = 0;
+    parts[n++] = node;
+    cdd_ref(node);
+    for (i = 0; i < num_clocks; i++) {
+        parts[n] = cdd_interval(clocks[i], 0, bnd_u2l(dbm_bound2raw(-clock_values[i], dbm_WEAK)),
+                                dbm_bound2raw(clock_values[i], dbm_WEAK));
+        cdd_ref(parts[n]);
+        n++;
+    }
+    for (i = 0; i < num_bools; i++) {
+        parts[n] = cdd_neg_cond(cdd_bddvar(bools[i]), bool_values[i] != 1);
+        cdd_ref(parts[n]);
+        n++;
+    }
+
+    res = cdd_and_n(parts, n);
+    if (res != NULL) {
+        cdd_ref(res);
+    }
+    cdd_drop_parts(parts, n);
+    if (res != NULL) {
+        cdd_deref(res);
+    }
+    return res;
+}
+
+/* Resets clocks by quantifying them away in one pass of
+ * cdd_exist_rec() and conjoining the result with the new values.
+ */
+ddNode* cdd_reset(ddNode* node, int32_t* clocks, int32_t* values, int32_t n)
+{
+    if (n == 0) {
+        return node;
+    }
+    return cdd_and_values(cdd_exist(node, NULL, clocks, 0, n), clocks, values, n, NULL, NULL, 0);
+}
+
+/* The image of a transition: the guard restricted to non-negative
+ * clocks is conjoined with the states and the reset variables are
+ * quantified in the same pass of cdd_and_exist(), after which all new
+ * values are conjoined at once. Only the guard is restricted on its
+ * own, which is cheap as it is small.
+ */
+ddNode* cdd_image(ddNode* state, ddNode* guard, int32_t* clocks, int32_t* clock_values, int32_t num_clocks,
+                  int32_t* bools, int32_t* bool_values, int32_t num_bools)
+{
+    ddNode* tmp1;
+    ddNode* tmp2;
+
+    tmp1 = cdd_remove_negative(guard);
+    if (tmp1 == NULL) {
+        return NULL;
+    }
+    cdd_ref(tmp1);
+    tmp2 = cdd_and_exist(state, tmp1, bools, clocks, num_bools, num_clocks);
+    /* The result may be a part of the guard, so it is referenced first */
+    if (tmp2 != NULL) {
+        cdd_ref(tmp2);
+    }
+    cdd_rec_deref(tmp1);
+    if (tmp2 == NULL) {
+        return NULL;
+    }
+    tmp1 = cdd_and_values(tmp2, clocks, clock_values, num_clocks, bools, bool_values, num_bools);
+    if (tmp1 != NULL) {
+        cdd_ref(tmp1);
+    }
+    cdd_rec_deref(tmp2);
+    if (tmp1 != NULL) {
+        cdd_deref(tmp1);
+    }
+    return tmp1;
+}
+
+/* The backward image of a transition: the update restricted to
+ * non-negative clocks is conjoined with the states and the reset
+ * variables are quantified in the same pass of cdd_and_exist(), after
+ * which the guard and the lower bounds of the freed clocks are
+ * conjoined at once. If neither the states nor the update constrain a
+ * clock, only the booleans are quantified and nothing is restricted to
+ * non-negative clocks.
+ */
+ddNode* cdd_preimage(ddNode* state, ddNode* guard, ddNode* update, int32_t* clocks, int32_t num_clocks,
+                     int32_t* bools, int32_t num_bools)
+{
+    ddNode** parts;
+    ddNode* tmp1;
+    ddNode* tmp2;
+    int32_t i;
+    int32_t n;
+
+    if ((cdd_isterminal(state) || cdd_node_type(state) == TYPE_BDD) &&
+        (cdd_isterminal(update) || cdd_node_type(update) == TYPE_BDD)) {
+        num_clocks = 0;
+    }
+    parts = malloc((num_clocks + 2) * sizeof(ddNode*));
+    if (parts == NULL) {
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+
+    if (num_clocks == 0) {
+        tmp1 = cdd_and_exist(state, update, bools, NULL, num_bools, 0);
+    } else {
+        tmp2 = cdd_remove_negative(update);
+        if (tmp2 == NULL) {
+            free(parts);
+            return NULL;
+        }
+        cdd_ref(tmp2);
+        tmp1 = cdd_and_exist(state, tmp2, bools, clocks, num_bools, num_clocks);
+        /* The result may be a part of the update */
+        if (tmp1 != NULL) {
+            cdd_ref(tmp1);
+        }
+        cdd_rec_deref(tmp2);
+        if (tmp1 != NULL) {
+            cdd_deref(tmp1);
+        }
+    }
+    if (tmp1 == NULL) {
+        free(parts);
+        return NULL;
+    }
+
+    n = 0;
+    parts[n++] = tmp1;
+    cdd_ref(tmp1);
+    parts[n++] = guard;
+    cdd_ref(guard);
+    for (i = 0; i < num_clocks; i++) {
+        parts[n] = cdd_interval(clocks[i], 0, 0, dbm_LS_INFINITY);
+        cdd_ref(parts[n]);
+        n++;
+    }
+
+    tmp1 = cdd_and_n(parts, n);
+    if (tmp1 != NULL) {
+        cdd_ref(tmp1);
+    }
+    cdd_drop_parts(parts, n);
+    if (tmp1 != NULL) {
+        cdd_deref(tmp1);
+    }
+    return tmp1;
+}
+
 /* // unused
 static void cdd_check(ddNode *node)
 {
@@ -459,7 +1797,7 @@ static void cdd_check(ddNode *node)
     if (cdd_isterminal(node)) {
         return;
     }
-    switch (cdd_info(node)->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         cdd_it_init(it, node);
         while (!cdd_it_atend(it)) {
@@ -552,6 +1890,7 @@ static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels, ddNode* c)
 
     entry = CddCache_lookup(&quantcache, EXISTHASH(node, c, opid));
     if (entry->a == node && entry->b == c && entry->c == opid) {
+        CddCache_hit(&quantcache);
         if (cdd_rglr(entry->res)->ref == 0) {
             cdd_reclaim(entry->res);
         }
@@ -561,7 +1900,7 @@ static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels, ddNode* c)
     level = cdd_rglr(node)->level;
     res = NULL;
     if (levels[level]) {
-        switch (cdd_info(node)->type) {
+        switch (cdd_node_type(node)) {
         case TYPE_CDD:
             res = cddfalse;
             for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
@@ -593,7 +1932,7 @@ static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels, ddNode* c)
             cdd_deref(res);
         }
     } else {
-        switch (cdd_info(node)->type) {
+        switch (cdd_node_type(node)) {
         case TYPE_CDD:
             res = cddfalse;
             for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
@@ -614,7 +1953,7 @@ static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels, ddNode* c)
             cdd_deref(res);
             break;
         case TYPE_BDD:
-            tmp1 = cdd_bddvar(level);
+            tmp1 = cdd_make_bdd_node(level, cddfalse, cddtrue);
             cdd_ref(tmp1);
             tmp2 = cdd_exist_rec(bdd_low(node), levels, c);
             cdd_ref(tmp2);
@@ -629,6 +1968,7 @@ static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels, ddNode* c)
         }
     }
 
+    CddCache_overwrite(&quantcache, entry->a);
     entry->a = node;
     entry->b = c;
     entry->c = opid;
@@ -637,6 +1977,88 @@ static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels, ddNode* c)
     return res;
 }
 #else
+/* Returns the number of children of a CDD node. */
+static size_t cdd_childcount(ddNode* node) { return cdd_node_len(node); }
+
+/* Dereferences n referenced pieces and releases the array. */
+static void cdd_drop_parts(ddNode** parts, size_t n)
+{
+    while (n > 0) {
+        cdd_rec_deref(parts[--n]);
+    }
+    free(parts);
+}
+
+/* Stack of the referenced pieces collected by relax(), cdd_exist_rec()
+ * and cdd_time_rec() at the CDD nodes on the current path. A visit
+ * claims one slot per child on top and gives them back before it
+ * returns, so the stack is only allocated once for the widest path
+ * and reused by later calls. Slots are addressed by index as the
+ * stack may move when it grows.
+ */
+static ddNode** partstack;
+static size_t partcapacity;
+static size_t partstop;
+
+static void cdd_parts_clear()
+{
+    free(partstack);
+    partstack = NULL;
+    partcapacity = partstop = 0;
+}
+
+/* Claims \a n slots on top of the part stack and stores the index of
+ * the first in \a base. Returns 0, or CDD_MEMORY if the stack cannot
+ * grow.
+ */
+static int32_t cdd_parts_claim(size_t n, size_t* base)
+{
+    ddNode** stack;
+    size_t capacity;
+
+    if (partstop + n > partcapacity) {
+        for (capacity = partcapacity > 0 ? partcapacity : 64; capacity < partstop + n; capacity <<= 1)
+            ;
+        stack = realloc(partstack, capacity * sizeof(ddNode*));
+        if (stack == NULL) {
+            return cdd_error(CDD_MEMORY);
+        }
+        partstack = stack;
+        partcapacity = capacity;
+    }
+    *base = partstop;
+    partstop += n;
+    return 0;
+}
+
+/* Dereferences the \a n referenced pieces from \a base and gives their
+ * slots back.
+ */
+static void cdd_parts_drop(size_t base, size_t n)
+{
+    while (n > 0) {
+        cdd_rec_deref(partstack[base + --n]);
+    }
+    partstop = base;
+}
+
+/* Computes the disjunction of the \a n referenced pieces from \a base.
+ * The pieces are dereferenced and their slots given back. The result
+ * is not referenced, and NULL if the disjunction failed.
+ */
+static ddNode* cdd_or_parts(size_t base, size_t n)
+{
+    ddNode* res = cdd_or_n(partstack + base, n);
+    if (res == NULL) {
+        cdd_parts_drop(base, n);
+        return NULL;
+    }
+    cdd_ref(res);
+    cdd_parts_drop(base, n);
+    cdd_deref(res);
+    return res;
+}
+
 static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1, int32_t clock2, raw_t upper, raw_t* rc)
 {
     LevelInfo* info;
@@ -646,7 +2068,8 @@ static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1,
     ddNode* tmp2;
     ddNode* tmp3;
     ddNode* tmp4;
-    ddNode* tmp5;
+    size_t parts;
+    size_t n;
     int32_t pos;
     int32_t neg;
     raw_t l;
@@ -663,6 +2086,7 @@ static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1,
     entry = CddCache_lookup(&relaxcache, RELAXHASH(node, lower, clock1, clock2, upper));
     if (entry->node == node && entry->lower == lower && entry->upper == upper && entry->clock1 == clock1 &&
         entry->clock2 == clock2 && entry->op == opid) {
+        CddCache_hit(&relaxcache);
         if (cdd_rglr(entry->res)->ref == 0) {
             cdd_reclaim(entry->res);
         }
@@ -675,7 +2099,10 @@ static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1,
     res = cddfalse;
     switch (info->type) {
     case TYPE_CDD:
-        res = cddfalse;
+        if (cdd_parts_claim(cdd_childcount(node), &parts) < 0) {
+            return NULL;
+        }
+        n = 0;
         cdd_it_init(it, node);
         while (!cdd_it_atend(it)) {
             // Detect consequences
@@ -706,6 +2133,10 @@ static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1,
             // Call relax recursively
 
             tmp2 = relax(cdd_it_child(it), clocks, lower, clock1, clock2, upper, rc);
+            if (tmp2 == NULL) {
+                cdd_parts_drop(parts, n);
+                return NULL;
+            }
             cdd_ref(tmp2);
 
             // Add consequence if tighter then those already removed
@@ -732,26 +2163,393 @@ static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1,
             tmp4 = cdd_and(tmp2, tmp3);
             cdd_ref(tmp4);
 
-            tmp5 = cdd_or(res, tmp4);
-            cdd_ref(tmp5);
-
             cdd_rec_deref(tmp2);
             cdd_rec_deref(tmp3);
-            cdd_rec_deref(tmp4);
-            cdd_rec_deref(res);
 
-            res = tmp5;
+            partstack[parts + n++] = tmp4;
             cdd_it_next(it);
         }
+        res = cdd_or_parts(parts, n);
+        if (res == NULL) {
+            return NULL;
+        }
         break;
     case TYPE_BDD:
         tmp1 = relax(bdd_low(node), clocks, lower, clock1, clock2, upper, rc);
+        if (tmp1 == NULL) {
+            return NULL;
+        }
         cdd_ref(tmp1);
 
         tmp2 = relax(bdd_high(node), clocks, lower, clock1, clock2, upper, rc);
+        if (tmp2 == NULL) {
+            cdd_rec_deref(tmp1);
+            return NULL;
+        }
+        cdd_ref(tmp2);
+
+        tmp3 = cdd_make_bdd_node(cdd_rglr(node)->level, cddfalse, cddtrue);
+        cdd_ref(tmp3);
+
+        res = cdd_ite(tmp3, tmp2, tmp1);
+        cdd_ref(res);
+        cdd_rec_deref(tmp1);
+        cdd_rec_deref(tmp2);
+        cdd_rec_deref(tmp3);
+        cdd_deref(res);
+    }
+
+#ifdef RELAXCACHE
+    CddCache_overwrite(&relaxcache, entry->node);
+    entry->node = node;
+    entry->lower = lower;
+    entry->upper = upper;
+    entry->clock1 = clock1;
+    entry->clock2 = clock2;
+    entry->op = opid;
+    entry->res = res;
+#endif
+
+    return res;
+}
+
+static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels_bool, int32_t* clocks, int32_t num_bool_resets,
+                             int32_t num_clock_resets, raw_t* rc)
+{
+    LevelInfo* info;
+    CddCacheData* entry;
+    cdd_iterator it;
+    ddNode* res;
+    ddNode* tmp1;
+    ddNode* tmp2;
+    ddNode* tmp3;
+    size_t parts;
+    size_t n;
+    raw_t old_lower, old_upper;
+
+    if (cdd_isterminal(node)) {
+        return node;
+    }
+
+    //    cdd2Dot("debug.dot", node, "InEx");
+    entry = CddCache_lookup(&quantcache, EXISTHASH(node));
+    if (entry->a == node && entry->c == opid) {
+        CddCache_hit(&quantcache);
+        if (cdd_rglr(entry->res)->ref == 0)
+            cdd_reclaim(entry->res);
+        return entry->res;
+    }
+
+    info = cdd_info(node);
+    res = NULL;
+    switch (info->type) {
+    case TYPE_CDD:
+        if (cdd_parts_claim(cdd_childcount(node), &parts) < 0) {
+            return NULL;
+        }
+        n = 0;
+        cdd_it_init(it, node);
+        bool level_affected_by_reset = clocks[info->clock1] || clocks[info->clock2];
+        if (level_affected_by_reset) {
+            while (!cdd_it_atend(it)) {
+                // Here we add the constraint32_t to rc - we save the old
+                // constraints so they can be restored.
+                old_lower = rc[info->clock2 * cdd_clocknum + info->clock1];
+                old_upper = rc[info->clock1 * cdd_clocknum + info->clock2];
+
+                rc[info->clock2 * cdd_clocknum + info->clock1] = bnd_l2u(cdd_it_lower(it));
+                rc[info->clock1 * cdd_clocknum + info->clock2] = cdd_it_upper(it);
+
+                tmp1 =
+                    relax(cdd_it_child(it), clocks, cdd_it_lower(it), info->clock1, info->clock2, cdd_it_upper(it), rc);
+                tmp2 = NULL;
+                if (tmp1 != NULL) {
+                    cdd_ref(tmp1);
+                    tmp2 = cdd_exist_rec(tmp1, levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
+                    if (tmp2 != NULL)
+                        cdd_ref(tmp2);
+                    cdd_rec_deref(tmp1);
+                }
+
+                // Here we restore the constraint
+                rc[info->clock2 * cdd_clocknum + info->clock1] = old_lower;
+                rc[info->clock1 * cdd_clocknum + info->clock2] = old_upper;
+
+                if (tmp2 == NULL) {
+                    cdd_parts_drop(parts, n);
+                    return NULL;
+                }
+                partstack[parts + n++] = tmp2;
+
+                cdd_it_next(it);
+            }
+        } else {
+            while (!cdd_it_atend(it)) {
+                tmp1 = cdd_interval_from_level(cdd_rglr(node)->level, cdd_it_lower(it), cdd_it_upper(it));
+                cdd_ref(tmp1);
+
+                tmp2 = cdd_exist_rec(cdd_it_child(it), levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
+                if (tmp2 == NULL) {
+                    cdd_rec_deref(tmp1);
+                    cdd_parts_drop(parts, n);
+                    return NULL;
+                }
+                cdd_ref(tmp2);
+
+                tmp3 = cdd_and(tmp1, tmp2);
+                cdd_ref(tmp3);
+
+                cdd_rec_deref(tmp1);
+                cdd_rec_deref(tmp2);
+                partstack[parts + n++] = tmp3;
+                cdd_it_next(it);
+            }
+        }
+        res = cdd_or_parts(parts, n);
+        if (res == NULL) {
+            return NULL;
+        }
+        break;
+    case TYPE_BDD:
+        tmp1 = cdd_exist_rec(bdd_low(node), levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
+        if (tmp1 == NULL) {
+            return NULL;
+        }
+        cdd_ref(tmp1);
+
+        tmp2 = cdd_exist_rec(bdd_high(node), levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
+        if (tmp2 == NULL) {
+            cdd_rec_deref(tmp1);
+            return NULL;
+        }
+        cdd_ref(tmp2);
+        // check if the bool
+        level_affected_by_reset = false;
+        for (int32_t i = 0; i < num_bool_resets; i++) {
+            level_affected_by_reset = levels_bool[i] == bdd_node(node)->level;
+            if (level_affected_by_reset)
+                break;
+        }
+
+        if (level_affected_by_reset) {  // TODO: check if the regularize here really was ment to be removed
+                                        // if (levels[cdd_rglr(node)->level]) {
+            res = cdd_or(tmp1, tmp2);
+            cdd_ref(res);
+        } else {
+            tmp3 = cdd_make_bdd_node(cdd_rglr(node)->level, cddfalse, cddtrue);
+            cdd_ref(tmp3);
+            res = cdd_ite(tmp3, tmp2, tmp1);
+            cdd_ref(res);
+            cdd_rec_deref(tmp3);
+        }
+
+        cdd_rec_deref(tmp1);
+        cdd_rec_deref(tmp2);
+        cdd_deref(res);
+    }
+
+    CddCache_overwrite(&quantcache, entry->a);
+    entry->a = node;
+    entry->c = opid;
+    entry->res = res;
+
+    return res;
+}
+
+/* Existential quantification of the boolean levels flagged in \a
+ * levels only. Clock levels are not affected, so CDD nodes are copied
+ * one to one with their quantified children and nodes below the last
+ * quantified level \a last are returned as they are.
+ */
+static ddNode* cdd_exist_bool_rec(ddNode* node, char* levels, int32_t last)
+{
+    CddCacheData* entry;
+    cdd_iterator it;
+    ddNode* res;
+    ddNode* m;
+    ddNode* n;
+    Elem* top;
+    int32_t mask;
+
+    if (cdd_isterminal(node) || cdd_rglr(node)->level > last) {
+        return node;
+    }
+
+    entry = CddCache_lookup(&quantcache, EXISTHASH(node));
+    if (entry->a == node && entry->c == opid) {
+        CddCache_hit(&quantcache);
+        if (cdd_rglr(entry->res)->ref == 0)
+            cdd_reclaim(entry->res);
+        return entry->res;
+    }
+
+    switch (cdd_node_type(node)) {
+    case TYPE_CDD:
+        /* Same construction as in cdd_tarjan_reduce_rec(): adjacent
+         * children that became equal are merged. */
+        cdd_it_init(it, node);
+        m = cdd_exist_bool_rec(cdd_it_child(it), levels, last);
+        mask = cdd_mask(m);
+        cdd_ref(m);
+        top = cdd_refstacktop;
+        for (cdd_it_next(it); !cdd_it_atend(it); cdd_it_next(it)) {
+            n = cdd_exist_bool_rec(cdd_it_child(it), levels, last);
+            if (m != n) {
+                cdd_push(cdd_neg_cond(m, mask), cdd_it_lower(it));
+                m = n;
+                cdd_ref(m);
+            }
+        }
+        cdd_push(cdd_neg_cond(m, mask), INF);
+        res = cdd_neg_cond(cdd_make_cdd_node(cdd_rglr(node)->level, top, cdd_refstacktop - top), mask);
+        cdd_ref(res);
+        while (cdd_refstacktop > top) {
+            cdd_refstacktop--;
+            cdd_deref(cdd_refstacktop->child);
+        }
+        cdd_deref(res);
+        break;
+    case TYPE_BDD:
+        m = cdd_exist_bool_rec(bdd_low(node), levels, last);
+        cdd_ref(m);
+        n = cdd_exist_bool_rec(bdd_high(node), levels, last);
+        cdd_ref(n);
+        if (levels[cdd_rglr(node)->level]) {
+            res = cdd_or(m, n);
+        } else {
+            res = cdd_make_bdd_node(cdd_rglr(node)->level, m, n);
+        }
+        cdd_ref(res);
+        cdd_rec_deref(m);
+        cdd_rec_deref(n);
+        cdd_deref(res);
+        break;
+    default: res = NULL;
+    }
+
+    CddCache_overwrite(&quantcache, entry->a);
+    entry->a = node;
+    entry->c = opid;
+    entry->res = res;
+
+    return res;
+}
+#endif
+
+/* Lets time elapse on the structure of a diagram. Delaying by d turns
+ * every level x_i - x_0 into x_i - d for a fresh d >= 0, which is then
+ * eliminated by Fourier-Motzkin: relax() adds the consequence of each
+ * pair of such levels on a path to x_i - x_j, and pairing a level with
+ * d >= 0 keeps its lower bound. For the past d <= 0 and the upper
+ * bound is kept instead. All other levels are unaffected.
+ *
+ * The result is intersected with \a inv at the terminals, so that no
+ * part of the future outside the invariant is ever built, and children
+ * whose remaining bound lies outside the bounds \a invb of the
+ * invariant on their level are skipped before they are relaxed. \a inv
+ * and \a invb are the same for the whole operation; \a invb is NULL
+ * if \a inv is true.
+ */
+static ddNode* cdd_time_rec(ddNode* node, ddNode* inv, const raw_t* invb, int32_t past, int32_t* clocks, raw_t* rc)
+{
+    LevelInfo* info;
+    CddCacheData* entry;
+    cdd_iterator it;
+    ddNode* res;
+    ddNode* tmp1;
+    ddNode* tmp2;
+    ddNode* tmp3;
+    size_t parts;
+    size_t n;
+    int32_t level;
+    raw_t lower, upper;
+
+    if (cdd_isterminal(node)) {
+        return cdd_and(node, inv);
+    }
+
+    entry = CddCache_lookup(&quantcache, EXISTHASH(node));
+    if (entry->a == node && entry->c == opid) {
+        CddCache_hit(&quantcache);
+        if (cdd_rglr(entry->res)->ref == 0)
+            cdd_reclaim(entry->res);
+        return entry->res;
+    }
+
+    info = cdd_info(node);
+    res = NULL;
+    switch (info->type) {
+    case TYPE_CDD:
+        if (cdd_parts_claim(cdd_childcount(node), &parts) < 0) {
+            return NULL;
+        }
+        n = 0;
+        level = cdd_rglr(node)->level;
+        for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
+            if (IS_FALSE(cdd_it_child(it))) {
+                continue;
+            }
+            lower = cdd_it_lower(it);
+            upper = cdd_it_upper(it);
+            if (info->clock2 == 0) {
+                if (past) {
+                    lower = -INF;
+                } else {
+                    upper = INF;
+                }
+            }
+            if (invb != NULL && maximum(lower, invb[2 * level]) >= minimum(upper, invb[2 * level + 1])) {
+                continue;
+            }
+
+            if (info->clock2 == 0) {
+                tmp2 = relax(cdd_it_child(it), clocks, cdd_it_lower(it), info->clock1, 0, cdd_it_upper(it), rc);
+                tmp3 = NULL;
+                if (tmp2 != NULL) {
+                    cdd_ref(tmp2);
+                    tmp3 = cdd_time_rec(tmp2, inv, invb, past, clocks, rc);
+                    if (tmp3 != NULL)
+                        cdd_ref(tmp3);
+                    cdd_rec_deref(tmp2);
+                }
+            } else {
+                tmp3 = cdd_time_rec(cdd_it_child(it), inv, invb, past, clocks, rc);
+                if (tmp3 != NULL)
+                    cdd_ref(tmp3);
+            }
+            if (tmp3 == NULL) {
+                cdd_parts_drop(parts, n);
+                return NULL;
+            }
+
+            tmp1 = cdd_interval_from_level(level, lower, upper);
+            cdd_ref(tmp1);
+            tmp2 = cdd_and(tmp1, tmp3);
+            cdd_ref(tmp2);
+            cdd_rec_deref(tmp1);
+            cdd_rec_deref(tmp3);
+            partstack[parts + n++] = tmp2;
+        }
+        res = cdd_or_parts(parts, n);
+        if (res == NULL) {
+            return NULL;
+        }
+        break;
+    case TYPE_BDD:
+        tmp1 = cdd_time_rec(bdd_low(node), inv, invb, past, clocks, rc);
+        if (tmp1 == NULL) {
+            return NULL;
+        }
+        cdd_ref(tmp1);
+
+        tmp2 = cdd_time_rec(bdd_high(node), inv, invb, past, clocks, rc);
+        if (tmp2 == NULL) {
+            cdd_rec_deref(tmp1);
+            return NULL;
+        }
         cdd_ref(tmp2);
 
-        tmp3 = cdd_bddvar(cdd_rglr(node)->level);
+        tmp3 = cdd_make_bdd_node(cdd_rglr(node)->level, cddfalse, cddtrue);
         cdd_ref(tmp3);
 
         res = cdd_ite(tmp3, tmp2, tmp1);
@@ -762,155 +2560,200 @@ static ddNode* relax(ddNode* node, int32_t* clocks, raw_t lower, int32_t clock1,
         cdd_deref(res);
     }
 
-#ifdef RELAXCACHE
-    entry->node = node;
-    entry->lower = lower;
-    entry->upper = upper;
-    entry->clock1 = clock1;
-    entry->clock2 = clock2;
-    entry->op = opid;
+    CddCache_overwrite(&quantcache, entry->a);
+    entry->a = node;
+    entry->c = opid;
     entry->res = res;
-#endif
 
     return res;
 }
 
-static ddNode* cdd_exist_rec(ddNode* node, int32_t* levels_bool, int32_t* clocks, int32_t num_bool_resets,
-                             int32_t num_clock_resets, raw_t* rc)
+/* Collects in \a bnds the hull of the intervals of \a node on each
+ * level, over the paths that do not end in false. The edges into
+ * \a node skip the levels from \a from up to its own, which are
+ * counted in \a skips as differences. Visited nodes are recorded in
+ * the quantification cache under the current opid.
+ */
+static void cdd_inv_bounds_rec(ddNode* node, int32_t from, raw_t* bnds, int32_t* skips)
 {
-    LevelInfo* info;
     CddCacheData* entry;
     cdd_iterator it;
-    ddNode* res;
-    ddNode* tmp1;
-    ddNode* tmp2;
-    ddNode* tmp3;
-    ddNode* tmp4;
-    raw_t old_lower, old_upper;
+    int32_t level;
 
+    if (IS_FALSE(node)) {
+        return;
+    }
+    level = cdd_isterminal(node) ? cdd_levelcnt : cdd_rglr(node)->level;
+    if (from < level) {
+        skips[from]++;
+        skips[level]--;
+    }
     if (cdd_isterminal(node)) {
-        return node;
+        return;
     }
 
-    //    cdd2Dot("debug.dot", node, "InEx");
     entry = CddCache_lookup(&quantcache, EXISTHASH(node));
     if (entry->a == node && entry->c == opid) {
-        if (cdd_rglr(entry->res)->ref == 0)
-            cdd_reclaim(entry->res);
-        return entry->res;
+        CddCache_hit(&quantcache);
+        return;
     }
+    CddCache_overwrite(&quantcache, entry->a);
+    entry->a = node;
+    entry->c = opid;
+    entry->res = node;
 
-    info = cdd_info(node);
-    res = NULL;
-    switch (info->type) {
-    case TYPE_CDD:
-        res = cddfalse;
-        cdd_it_init(it, node);
-        bool level_affected_by_reset = false;
-        for (int32_t i = 0; i < num_clock_resets; i++) {
-            level_affected_by_reset = clocks[i] == info->clock1 || clocks[i] == info->clock2;
-            if (level_affected_by_reset)
-                break;
+    if (cdd_info(node)->type == TYPE_CDD) {
+        for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
+            if (IS_FALSE(cdd_it_child(it))) {
+                continue;
+            }
+            bnds[2 * level] = minimum(bnds[2 * level], cdd_it_lower(it));
+            bnds[2 * level + 1] = maximum(bnds[2 * level + 1], cdd_it_upper(it));
+            cdd_inv_bounds_rec(cdd_it_child(it), level + 1, bnds, skips);
         }
-        if (level_affected_by_reset) {
-            while (!cdd_it_atend(it)) {
-                // Here we add the constraint32_t to rc - we save the old
-                // constraints so they can be restored.
-                old_lower = rc[info->clock2 * cdd_clocknum + info->clock1];
-                old_upper = rc[info->clock1 * cdd_clocknum + info->clock2];
-
-                rc[info->clock2 * cdd_clocknum + info->clock1] = bnd_l2u(cdd_it_lower(it));
-                rc[info->clock1 * cdd_clocknum + info->clock2] = cdd_it_upper(it);
-
-                tmp1 =
-                    relax(cdd_it_child(it), clocks, cdd_it_lower(it), info->clock1, info->clock2, cdd_it_upper(it), rc);
-
-                cdd_ref(tmp1);
-
-                tmp2 = cdd_exist_rec(tmp1, levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
-                cdd_ref(tmp2);
-
-                tmp3 = cdd_or(res, tmp2);
-                cdd_ref(tmp3);
+    } else {
+        cdd_inv_bounds_rec(bdd_low(node), level + 1, bnds, skips);
+        cdd_inv_bounds_rec(bdd_high(node), level + 1, bnds, skips);
+    }
+}
 
-                cdd_rec_deref(res);
-                cdd_rec_deref(tmp1);
-                cdd_rec_deref(tmp2);
-                res = tmp3;
+/* Computes the bounds of \a inv on each level as pairs of a lower and
+ * an upper bound. A level skipped by some path is unbounded. Returns
+ * NULL if out of memory.
+ */
+static raw_t* cdd_inv_bounds(ddNode* inv)
+{
+    raw_t* bnds;
+    int32_t* skips;
+    int32_t i, skipped;
 
-                // Here we restore the constraint
-                rc[info->clock2 * cdd_clocknum + info->clock1] = old_lower;
-                rc[info->clock1 * cdd_clocknum + info->clock2] = old_upper;
+    bnds = malloc(2 * cdd_levelcnt * sizeof(raw_t) + (cdd_levelcnt + 1) * sizeof(int32_t));
+    if (bnds == NULL) {
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+    skips = (int32_t*)(bnds + 2 * cdd_levelcnt);
+    for (i = 0; i < cdd_levelcnt; i++) {
+        bnds[2 * i] = INF;
+        bnds[2 * i + 1] = -INF;
+        skips[i] = 0;
+    }
+    skips[cdd_levelcnt] = 0;
 
-                cdd_it_next(it);
-            }
-        } else {
-            while (!cdd_it_atend(it)) {
-                tmp1 = cdd_interval_from_level(cdd_rglr(node)->level, cdd_it_lower(it), cdd_it_upper(it));
-                cdd_ref(tmp1);
+    opid++;
+    cdd_inv_bounds_rec(inv, 0, bnds, skips);
+    for (i = 0, skipped = 0; i < cdd_levelcnt; i++) {
+        skipped += skips[i];
+        if (skipped > 0) {
+            bnds[2 * i] = -INF;
+            bnds[2 * i + 1] = INF;
+        }
+    }
+    return bnds;
+}
 
-                tmp2 = cdd_exist_rec(cdd_it_child(it), levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
-                cdd_ref(tmp2);
+/* Lets time elapse on the non-negative part of \a node within \a inv.
+ * Only the reference clock is eliminated; relax() reads the clocks as
+ * flags per clock.
+ */
+static ddNode* cdd_time(ddNode* node, ddNode* inv, int32_t past)
+{
+    int32_t i;
+    int32_t clocks[cdd_clocknum];
+    raw_t removed_constraint[cdd_clocknum * cdd_clocknum];
+    raw_t* invb = NULL;
+    ddNode* res;
 
-                tmp3 = cdd_and(tmp1, tmp2);
-                cdd_ref(tmp3);
+    for (i = 0; i < cdd_clocknum; i++) {
+        clocks[i] = 0;
+    }
+    clocks[0] = 1;
+    for (i = 0; i < cdd_clocknum * cdd_clocknum; i++) {
+        removed_constraint[i] = INF;
+    }
 
-                tmp4 = cdd_or(res, tmp3);
-                cdd_ref(tmp4);
+    if (inv != cddtrue && (invb = cdd_inv_bounds(inv)) == NULL) {
+        return NULL;
+    }
 
-                cdd_rec_deref(res);
-                cdd_rec_deref(tmp1);
-                cdd_rec_deref(tmp2);
-                cdd_rec_deref(tmp3);
-                res = tmp4;
-                cdd_it_next(it);
-            }
-        }
+    node = cdd_remove_negative(node);
+    if (node == NULL) {
+        free(invb);
+        return NULL;
+    }
+    cdd_ref(node);
+    opid++;
+    res = cdd_time_rec(node, inv, invb, past, clocks, removed_constraint);
+    if (res != NULL) {
+        cdd_ref(res);
+    }
+    cdd_rec_deref(node);
+    free(invb);
+    if (res != NULL) {
         cdd_deref(res);
-        break;
-    case TYPE_BDD:
-        tmp1 = cdd_exist_rec(bdd_low(node), levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
-        cdd_ref(tmp1);
+    }
+    return res;
+}
 
-        tmp2 = cdd_exist_rec(bdd_high(node), levels_bool, clocks, num_bool_resets, num_clock_resets, rc);
-        cdd_ref(tmp2);
-        // check if the bool
-        level_affected_by_reset = false;
-        for (int32_t i = 0; i < num_bool_resets; i++) {
-            level_affected_by_reset = levels_bool[i] == bdd_node(node)->level;
-            if (level_affected_by_reset)
-                break;
-        }
+ddNode* cdd_delay(ddNode* node)
+{
+    ddNode* res;
+    CDD_TRACE_BEGIN(span, node, NULL);
+    res = cdd_time(node, cddtrue, 0);
+    CDD_TRACE_END(span, "cdd_delay", -1, res);
+    return res;
+}
 
-        if (level_affected_by_reset) {  // TODO: check if the regularize here really was ment to be removed
-                                        // if (levels[cdd_rglr(node)->level]) {
-            res = cdd_or(tmp1, tmp2);
-            cdd_ref(res);
-        } else {
-            tmp3 = cdd_bddvar(cdd_rglr(node)->level);  // TODO: test if we can remove regularization
-            cdd_ref(tmp3);
-            res = cdd_ite(tmp3, tmp2, tmp1);
-            cdd_ref(res);
-            cdd_rec_deref(tmp3);
-        }
+ddNode* cdd_delay_invariant(ddNode* node, ddNode* inv) { return cdd_time(node, inv, 0); }
 
-        cdd_rec_deref(tmp1);
-        cdd_rec_deref(tmp2);
-        cdd_deref(res);
+ddNode* cdd_past(ddNode* node)
+{
+    ddNode* res;
+    res = cdd_time(node, cddtrue, 1);
+    if (res == NULL) {
+        return NULL;
     }
-
-    entry->a = node;
-    entry->c = opid;
-    entry->res = res;
-
-    return res;
+    cdd_ref(res);
+    node = cdd_remove_negative(res);
+    if (node != NULL) {
+        cdd_ref(node);
+    }
+    cdd_rec_deref(res);
+    if (node != NULL) {
+        cdd_deref(node);
+    }
+    return node;
 }
-#endif
 
 ddNode* cdd_replace(ddNode* node, int32_t* levels, int32_t* clocks)
 {
-    opid++;
-    return cdd_replace_rec(node, levels, clocks);
+    ddNode* res;
+    int32_t *key, *bools;
+    int32_t i, sig;
+    int32_t n = 0;
+
+    /* The signature is the substitution of the boolean levels and of
+     * the clocks, which is all cdd_replace_rec() looks at. */
+    bools = cdd_bool_levels();
+    key = cdd_signature_key(cdd_varnum + cdd_clocknum + 1);
+    if (bools == NULL || key == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < cdd_varnum; i++) {
+        key[n++] = levels[bools[i]];
+    }
+    key[n++] = -1;
+    for (i = 0; i < cdd_clocknum; i++) {
+        key[n++] = clocks[i];
+    }
+    /* Interning may draw a fresh id from opid, so opid is saved after
+     * it and restored afterwards */
+    sig = cdd_signature_id(key, n);
+    i = opid;
+    opid = sig;
+    res = cdd_replace_rec(node, levels, clocks);
+    opid = i;
+    return res;
 }
 
 static ddNode* cdd_replace_rec(ddNode* node, int32_t* levels, int32_t* clocks)
@@ -929,6 +2772,7 @@ static ddNode* cdd_replace_rec(ddNode* node, int32_t* levels, int32_t* clocks)
 
     entry = CddCache_lookup(&replacecache, REPLACEHASH(node));
     if (entry->a == node && entry->c == opid) {
+        CddCache_hit(&replacecache);
         if (cdd_rglr(entry->res)->ref == 0)
             cdd_reclaim(entry->res);
         return entry->res;
@@ -938,7 +2782,7 @@ static ddNode* cdd_replace_rec(ddNode* node, int32_t* levels, int32_t* clocks)
     res = NULL;
     switch (info->type) {
     case TYPE_BDD:
-        tmp1 = cdd_bddvar(levels[cdd_rglr(node)->level]);
+        tmp1 = cdd_bddvar(levels[cdd_level2var[cdd_rglr(node)->level]]);
         cdd_ref(tmp1);
         tmp2 = cdd_replace_rec(bdd_low(node), levels, clocks);
         cdd_ref(tmp2);
@@ -971,6 +2815,7 @@ static ddNode* cdd_replace_rec(ddNode* node, int32_t* levels, int32_t* clocks)
         cdd_deref(res);
     }
 
+    CddCache_overwrite(&replacecache, entry->a);
     entry->a = node;
     entry->c = opid;
     entry->res = res;
@@ -978,20 +2823,21 @@ static ddNode* cdd_replace_rec(ddNode* node, int32_t* levels, int32_t* clocks)
     return res;
 }
 #if 1
-ddNode* cdd_from_dbm(const raw_t* dbm, uint32_t dim)
+/* Builds the part of the CDD of a DBM below (and including) level
+ * \a from. \a ok holds the minimal constraints of the DBM as computed
+ * by dbm_analyzeForMinDBM().
+ */
+static ddNode* cdd_from_dbm_levels(const raw_t* dbm, uint32_t dim, const uint32_t* ok, int32_t from)
 {
     int32_t i;
     int32_t j;
     int32_t k;
-    uint32_t ok[bits2intsize(dim * dim)];
     int32_t lo, hi;
     Elem* top;
     ddNode* c;
     ddNode* tmp;
     LevelInfo* info;
 
-    dbm_analyzeForMinDBM(dbm, dim, ok);
-
     /* Create CDD
      *
      * The idea is to build the CDD bottom-up by traversing all
@@ -1000,7 +2846,7 @@ ddNode* cdd_from_dbm(const raw_t* dbm, uint32_t dim)
      * lower bound on the node.
      */
     c = cddtrue;
-    for (k = cdd_levelcnt - 1; k >= 0; k--) {
+    for (k = cdd_levelcnt - 1; k >= from; k--) {
         info = cdd_levelinfo + k;
         if (info->type != TYPE_CDD) {
             continue;
@@ -1047,8 +2893,261 @@ ddNode* cdd_from_dbm(const raw_t* dbm, uint32_t dim)
         }
     }
 
-    cdd_deref(c);
-    return c;
+    cdd_deref(c);
+    return c;
+}
+
+ddNode* cdd_from_dbm(const raw_t* dbm, uint32_t dim)
+{
+    uint32_t ok[bits2intsize(dim * dim)];
+
+    dbm_analyzeForMinDBM(dbm, dim, ok);
+    return cdd_from_dbm_levels(dbm, dim, ok, 0);
+}
+
+/* Shared state of cdd_from_dbms_rec(). */
+struct dbm_batch
+{
+    const raw_t* const* dbms;  // The zones
+    uint32_t dim;              // Dimension of the zones
+    uint32_t* ok;              // Minimal constraints, okwords per zone
+    size_t okwords;
+};
+
+static int raw_compare(const void* a, const void* b)
+{
+    raw_t x = *(const raw_t*)a;
+    raw_t y = *(const raw_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Returns the index of \a b in the sorted array \a bnds of size n. */
+static size_t raw_index(const raw_t* bnds, size_t n, raw_t b)
+{
+    size_t lo = 0;
+    size_t hi = n;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (bnds[mid] < b) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Builds the union of the zones idx[0..m-1] restricted to the levels
+ * below (and including) \a from.
+ *
+ * The minimal constraints of the zones on the first constrained level
+ * split the level into segments such that every zone either covers a
+ * segment or is disjoint from it. For every segment the zones
+ * covering it are grouped and the recursion continues on the group,
+ * so that zones sharing a prefix of constraints are merged trie-style
+ * and common suffixes are shared through the unique table. If the
+ * zones overlap so much that the grouping duplicates them over many
+ * segments, the zones are built individually and joined by
+ * cdd_or_n().
+ */
+static ddNode* cdd_from_dbms_rec(struct dbm_batch* batch, size_t* idx, size_t m, int32_t from)
+{
+    const uint32_t dim = batch->dim;
+    LevelInfo* info;
+    const raw_t* dbm;
+    const uint32_t* ok;
+    raw_t* bnds;
+    size_t* first;
+    size_t* last;
+    size_t* group;
+    size_t nbnds, covered, g, s, z;
+    int32_t k, i, j, mask;
+    Elem* top;
+    ddNode* prev;
+    ddNode* n;
+    ddNode** parts;
+
+    if (m == 0) {
+        return cddfalse;
+    }
+    if (m == 1) {
+        z = idx[0];
+        return cdd_from_dbm_levels(batch->dbms[z], dim, batch->ok + z * batch->okwords, from);
+    }
+
+    /* Find the first level constrained by any of the zones.
+     */
+    for (k = from; k < cdd_levelcnt; k++) {
+        info = cdd_levelinfo + k;
+        if (info->type != TYPE_CDD || info->clock1 >= dim || info->clock2 >= dim) {
+            continue;
+        }
+        for (z = 0; z < m; z++) {
+            ok = batch->ok + idx[z] * batch->okwords;
+            if (base_getOneBit(ok, info->clock2 * dim + info->clock1) ||
+                base_getOneBit(ok, info->clock1 * dim + info->clock2)) {
+                break;
+            }
+        }
+        if (z < m) {
+            break;
+        }
+    }
+    if (k == cdd_levelcnt) {
+        /* None of the zones constrain the remaining levels. */
+        return cddtrue;
+    }
+    i = cdd_levelinfo[k].clock1;
+    j = cdd_levelinfo[k].clock2;
+
+    /* Collect the bounds of all zones on level k. A zone spans the
+     * segments first[z] to last[z], where segment s lies between
+     * bnds[s - 1] and bnds[s].
+     */
+    bnds = malloc(2 * m * sizeof(raw_t) + 3 * m * sizeof(size_t));
+    if (bnds == NULL) {
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+    first = (size_t*)(bnds + 2 * m);
+    last = first + m;
+    group = last + m;
+    nbnds = 0;
+    for (z = 0; z < m; z++) {
+        dbm = batch->dbms[idx[z]];
+        ok = batch->ok + idx[z] * batch->okwords;
+        if (base_getOneBit(ok, j * dim + i)) {
+            bnds[nbnds++] = bnd_u2l(dbm[j * dim + i]);
+        }
+        if (base_getOneBit(ok, i * dim + j)) {
+            bnds[nbnds++] = dbm[i * dim + j];
+        }
+    }
+    qsort(bnds, nbnds, sizeof(raw_t), raw_compare);
+    for (s = 0, g = 0; g < nbnds; g++) {
+        if (s == 0 || bnds[s - 1] != bnds[g]) {
+            bnds[s++] = bnds[g];
+        }
+    }
+    nbnds = s;
+
+    covered = 0;
+    for (z = 0; z < m; z++) {
+        dbm = batch->dbms[idx[z]];
+        ok = batch->ok + idx[z] * batch->okwords;
+        first[z] = base_getOneBit(ok, j * dim + i) ? raw_index(bnds, nbnds, bnd_u2l(dbm[j * dim + i])) + 1 : 0;
+        last[z] = base_getOneBit(ok, i * dim + j) ? raw_index(bnds, nbnds, dbm[i * dim + j]) : nbnds;
+        covered += last[z] - first[z] + 1;
+    }
+
+    if (covered > 4 * m || nbnds >= (size_t)cdd_maxcddsize) {
+        /* Grouping does not pay off: build the zones one by one.
+         */
+        free(bnds);
+        parts = malloc(m * sizeof(ddNode*));
+        if (parts == NULL) {
+            cdd_error(CDD_MEMORY);
+            return NULL;
+        }
+        for (z = 0; z < m; z++) {
+            parts[z] = cdd_from_dbm_levels(batch->dbms[idx[z]], dim, batch->ok + idx[z] * batch->okwords, k);
+            cdd_ref(parts[z]);
+        }
+        n = cdd_or_n(parts, m);
+        if (n != NULL) {
+            cdd_ref(n);
+        }
+        for (z = 0; z < m; z++) {
+            cdd_rec_deref(parts[z]);
+        }
+        free(parts);
+        if (n != NULL) {
+            cdd_deref(n);
+        }
+        return n;
+    }
+
+    /* Recurse on the group of zones covering each segment and merge
+     * adjacent segments with identical children.
+     */
+    top = cdd_refstacktop;
+    prev = NULL;
+    mask = 0;
+    for (s = 0; s <= nbnds; s++) {
+        for (g = 0, z = 0; z < m; z++) {
+            if (first[z] <= s && s <= last[z]) {
+                group[g++] = idx[z];
+            }
+        }
+        n = cdd_from_dbms_rec(batch, group, g, k + 1);
+        if (n == NULL) {
+            break;
+        }
+        if (prev == NULL) {
+            prev = n;
+            cdd_ref(prev);
+            mask = cdd_mask(prev);
+        } else if (n != prev) {
+            cdd_push(cdd_neg_cond(prev, mask), bnds[s - 1]);
+            prev = n;
+            cdd_ref(prev);
+        }
+    }
+    free(bnds);
+    if (n == NULL) {
+        /* Drop the children collected so far */
+        if (prev != NULL) {
+            cdd_deref(prev);
+        }
+        while (cdd_refstacktop > top) {
+            cdd_refstacktop--;
+            cdd_deref(cdd_refstacktop->child);
+        }
+        return NULL;
+    }
+    cdd_push(cdd_neg_cond(prev, mask), INF);
+
+    n = cdd_neg_cond(cdd_make_cdd_node(k, top, cdd_refstacktop - top), mask);
+    while (cdd_refstacktop > top) {
+        cdd_refstacktop--;
+        cdd_deref(cdd_refstacktop->child);
+    }
+    return n;
+}
+
+ddNode* cdd_from_dbms(const raw_t* const* dbms, size_t n, uint32_t dim)
+{
+    struct dbm_batch batch;
+    size_t* idx;
+    ddNode* res;
+    size_t z;
+
+    if (n == 0) {
+        return cddfalse;
+    }
+
+    batch.dbms = dbms;
+    batch.dim = dim;
+    batch.okwords = bits2intsize(dim * dim);
+    batch.ok = malloc(n * batch.okwords * sizeof(uint32_t));
+    idx = malloc(n * sizeof(size_t));
+    if (batch.ok == NULL || idx == NULL) {
+        free(batch.ok);
+        free(idx);
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+    for (z = 0; z < n; z++) {
+        assert(dbm_isValid(dbms[z], dim));
+        dbm_analyzeForMinDBM(dbms[z], dim, batch.ok + z * batch.okwords);
+        idx[z] = z;
+    }
+
+    res = cdd_from_dbms_rec(&batch, idx, n, 0);
+
+    free(idx);
+    free(batch.ok);
+    return res;
 }
 #else
 ddNode* cdd_from_dbm(const raw_t* dbm, int32_t size)
@@ -1114,13 +3213,194 @@ ddNode* cdd_from_dbm(const raw_t* dbm, int32_t size)
 }
 #endif
 
+/* Builds the tables of cdd_remove_negative() for the current number
+ * of clocks: the levels of the differences x_i - x_0 in increasing
+ * order and, for each k, the diagram of x_i >= 0 for the levels from
+ * nonneg_levels[k] on. Entry 0 is thus the non-negative part of the
+ * whole clock space.
+ */
+static int32_t cdd_nonneg_init()
+{
+    ddNode* tmp1;
+    ddNode* tmp2;
+    int32_t i, k;
+
+    if (nonneg_suffix != NULL && nonneg_clocknum == cdd_clocknum) {
+        return 0;
+    }
+    cdd_nonneg_clear(1);
+
+    nonneg_cnt = cdd_clocknum > 1 ? cdd_clocknum - 1 : 0;
+    nonneg_levels = malloc((nonneg_cnt + 1) * sizeof(int32_t));
+    nonneg_suffix = malloc((nonneg_cnt + 1) * sizeof(ddNode*));
+    if (nonneg_levels == NULL || nonneg_suffix == NULL) {
+        cdd_nonneg_clear(0);
+        return cdd_error(CDD_MEMORY);
+    }
+    for (i = 1; i < cdd_clocknum; i++) {
+        nonneg_levels[i - 1] = cdd_diff2level[cdd_difference(i, 0)];
+    }
+    qsort(nonneg_levels, nonneg_cnt, sizeof(int32_t), int32_compare);
+
+    nonneg_suffix[nonneg_cnt] = cddtrue;
+    for (k = nonneg_cnt - 1; k >= 0; k--) {
+        tmp1 = cdd_interval_from_level(nonneg_levels[k], 0, dbm_LS_INFINITY);
+        cdd_ref(tmp1);
+        tmp2 = cdd_and(tmp1, nonneg_suffix[k + 1]);
+        cdd_ref(tmp2);
+        cdd_rec_deref(tmp1);
+        nonneg_suffix[k] = tmp2;
+    }
+    nonneg_clocknum = cdd_clocknum;
+    return 0;
+}
+
+/* Conjoins \a node with x_i >= 0 for the levels in [from, to). The
+ * levels are above the root of \a node, so each conjunction only adds
+ * a node on top.
+ */
+static ddNode* cdd_nonneg_chain(ddNode* node, int32_t from, int32_t to)
+{
+    ddNode* tmp1;
+    ddNode* tmp2;
+    int32_t k;
+
+    cdd_ref(node);
+    for (k = nonneg_cnt - 1; k >= 0; k--) {
+        if (nonneg_levels[k] < from || nonneg_levels[k] >= to) {
+            continue;
+        }
+        tmp1 = cdd_interval_from_level(nonneg_levels[k], 0, dbm_LS_INFINITY);
+        cdd_ref(tmp1);
+        tmp2 = cdd_and(tmp1, node);
+        cdd_ref(tmp2);
+        cdd_rec_deref(tmp1);
+        cdd_rec_deref(node);
+        node = tmp2;
+    }
+    cdd_deref(node);
+    return node;
+}
+
+/* Restricts \a node to non-negative clock values, where the levels of
+ * x_i - x_0 above \a from have already been restricted on the path.
+ * Nodes on the x_i - x_0 levels get their negative intervals cut off
+ * and the levels skipped by an edge get the constraint added on top.
+ */
+static ddNode* cdd_remove_negative_rec(ddNode* node, int32_t from)
+{
+    CddCacheData* entry;
+    LevelInfo* info;
+    cdd_iterator it;
+    ddNode* res;
+    ddNode* tmp1;
+    ddNode* tmp2;
+    Elem* top;
+    Elem* elem;
+    int32_t level;
+    int32_t mask;
+    int32_t k;
+
+    if (node == cddfalse) {
+        return cddfalse;
+    }
+    if (cdd_isterminal(node)) {
+        for (k = 0; k < nonneg_cnt && nonneg_levels[k] < from; k++)
+            ;
+        return node == cddtrue ? nonneg_suffix[k] : cdd_and(nonneg_suffix[k], node);
+    }
+
+    level = cdd_rglr(node)->level;
+    entry = CddCache_lookup(&quantcache, EXISTHASH(node));
+    if (entry->a == node && entry->c == opid) {
+        CddCache_hit(&quantcache);
+        if (cdd_rglr(entry->res)->ref == 0)
+            cdd_reclaim(entry->res);
+        return cdd_nonneg_chain(entry->res, from, level);
+    }
+
+    info = cdd_info(node);
+    switch (info->type) {
+    case TYPE_CDD:
+        top = cdd_refstacktop;
+        for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
+            if (info->clock2 == 0 && info->clock1 != 0 && cdd_it_upper(it) <= 0) {
+                /* Only negative values */
+                tmp1 = cddfalse;
+            } else {
+                if (info->clock2 == 0 && info->clock1 != 0 && cdd_it_lower(it) < 0) {
+                    /* Cut off the negative values */
+                    if (cdd_refstacktop > top && cdd_refstacktop[-1].child == cddfalse) {
+                        cdd_refstacktop[-1].bnd = 0;
+                    } else {
+                        cdd_push(cddfalse, 0);
+                    }
+                }
+                tmp1 = cdd_remove_negative_rec(cdd_it_child(it), level + 1);
+            }
+            /* Merge with the previous child if equal */
+            if (cdd_refstacktop > top && cdd_refstacktop[-1].child == tmp1) {
+                cdd_refstacktop[-1].bnd = cdd_it_upper(it);
+            } else {
+                cdd_ref(tmp1);
+                cdd_push(tmp1, cdd_it_upper(it));
+            }
+        }
+        mask = cdd_mask(top->child);
+        for (elem = top; elem < cdd_refstacktop; elem++) {
+            elem->child = cdd_neg_cond(elem->child, mask);
+        }
+        res = cdd_neg_cond(cdd_make_cdd_node(level, top, cdd_refstacktop - top), mask);
+        cdd_ref(res);
+        while (cdd_refstacktop > top) {
+            cdd_refstacktop--;
+            cdd_rec_deref(cdd_neg_cond(cdd_refstacktop->child, mask));
+        }
+        cdd_deref(res);
+        break;
+    case TYPE_BDD:
+        tmp1 = cdd_remove_negative_rec(bdd_low(node), level + 1);
+        cdd_ref(tmp1);
+        tmp2 = cdd_remove_negative_rec(bdd_high(node), level + 1);
+        cdd_ref(tmp2);
+        res = cdd_make_bdd_node(level, tmp1, tmp2);
+        cdd_ref(res);
+        cdd_rec_deref(tmp1);
+        cdd_rec_deref(tmp2);
+        cdd_deref(res);
+        break;
+    default: res = NULL;
+    }
+
+    CddCache_overwrite(&quantcache, entry->a);
+    entry->a = node;
+    entry->c = opid;
+    entry->res = res;
+
+    return cdd_nonneg_chain(res, from, level);
+}
+
 ddNode* cdd_remove_negative(ddNode* cdd)
 {
-    ddNode* result = cdd;
-    for (int i = 1; i < cdd_clocknum; i++) {
-        result = cdd_apply(result, cdd_interval(i, 0, 0, dbm_LS_INFINITY), cddop_and);
+    ddNode* res;
+    int32_t key[2] = {-2, cdd_clocknum};
+    int32_t id, sig;
+
+    if (cdd_nonneg_init() < 0) {
+        return NULL;
     }
-    return result;
+    if (cdd == cddtrue) {
+        return nonneg_suffix[0];
+    }
+
+    /* The restriction of a node does not depend on the path to it, so
+     * it is cached across calls. */
+    sig = cdd_signature_id(key, 2);
+    id = opid;
+    opid = sig;
+    res = cdd_remove_negative_rec(cdd, 0);
+    opid = id;
+    return res;
 }
 
 ddNode* cdd_extract_dbm(ddNode* cdd, raw_t* dbm, uint32_t dim)
@@ -1173,6 +3453,216 @@ ddNode* cdd_extract_dbm(ddNode* cdd, raw_t* dbm, uint32_t dim)
     return result;
 }
 
+/* Classifies the leaves below \a node for cdd_contains_bottom():
+ * returns cddtrue if all of them are \a bottom, cddfalse if none is,
+ * and \a node otherwise. A node on a clock outside \a dim counts as a
+ * leaf other than \a bottom. The class does not depend on the zone
+ * reaching \a node, so it is kept in the quantification cache under
+ * the current opid.
+ */
+static ddNode* cdd_bottom_class(ddNode* node, uint32_t dim, ddNode* bottom)
+{
+    CddCacheData* entry;
+    cdd_iterator it;
+    LevelInfo* info;
+    ddNode* res;
+    int32_t all, none;
+
+    if (node == bottom) {
+        return cddtrue;
+    }
+    if (cdd_isterminal(node) || cdd_node_type(node) == TYPE_BDD) {
+        return cddfalse;
+    }
+    info = cdd_info(node);
+    if (info->clock1 >= dim || info->clock2 >= dim) {
+        return cddfalse;
+    }
+
+    entry = CddCache_lookup(&quantcache, EXISTHASH(node));
+    if (entry->a == node && entry->c == opid) {
+        CddCache_hit(&quantcache);
+        return entry->res;
+    }
+
+    all = none = 1;
+    for (cdd_it_init(it, node); !cdd_it_atend(it) && (all || none); cdd_it_next(it)) {
+        res = cdd_bottom_class(cdd_it_child(it), dim, bottom);
+        all &= res == cddtrue;
+        none &= res == cddfalse;
+    }
+    res = all ? cddtrue : none ? cddfalse : node;
+
+    CddCache_overwrite(&quantcache, entry->a);
+    entry->a = node;
+    entry->c = opid;
+    entry->res = res;
+    return res;
+}
+
+/* Returns true if every valuation of \a d in \a node reaches \a
+ * bottom. Unlike cdd_contains(), other boolean nodes and
+ * terminals do not count as containing \a d. The constrained zones
+ * are kept in the work space of cdd_contains_many_rec() at \a depth,
+ * and children are only visited when cdd_bottom_class() cannot tell.
+ */
+static int32_t cdd_contains_bottom(ddNode* node, const raw_t* d, int32_t depth, uint32_t dim, ddNode* bottom)
+{
+    raw_t* tmp;
+    cdd_iterator it;
+    LevelInfo* info;
+    ddNode* kind;
+
+    if (node == bottom) {
+        return 1;
+    }
+    if (cdd_isterminal(node) || cdd_node_type(node) == TYPE_BDD) {
+        return 0;
+    }
+
+    info = cdd_info(node);
+    if (info->clock1 >= dim || info->clock2 >= dim) {
+        return 0;
+    }
+
+    tmp = containsframes[depth].zones;
+    for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
+        kind = cdd_bottom_class(cdd_it_child(it), dim, bottom);
+        if (kind == cddtrue) {
+            continue;
+        }
+        dbm_copy(tmp, d, dim);
+        if (cdd_constrain2(tmp, dim, info->clock1, info->clock2, cdd_it_lower(it), cdd_it_upper(it)) &&
+            (kind == cddfalse || !cdd_contains_bottom(cdd_it_child(it), tmp, depth + 1, dim, bottom))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* One level on the path followed by cdd_extract_dbm_greedy(): the
+ * children first to last of the node are merged into one interval.
+ */
+typedef struct
+{
+    LevelInfo* info;
+    const raw_t* bnd;
+    int32_t n;
+    int32_t first;
+    int32_t last;
+} ExtractStep;
+
+/* Constrains \a dbm to the children \a first to \a last of \a step.
+ * Returns false if \a dbm becomes empty.
+ */
+static bool cdd_extract_step(const ExtractStep* step, int32_t first, int32_t last, raw_t* dbm, uint32_t dim)
+{
+    return cdd_constrain2(dbm, dim, step->info->clock1, step->info->clock2, first == 0 ? -INF : step->bnd[first - 1],
+                          step->bnd[last]);
+}
+
+/* Writes the zone given by the intervals of \a steps, except \a skip,
+ * to \a dbm.
+ */
+static void cdd_extract_steps(const ExtractStep* steps, int32_t depth, const ExtractStep* skip, raw_t* dbm,
+                              uint32_t dim)
+{
+    int32_t k;
+    dbm_init(dbm, dim);
+    for (k = 0; k < depth; k++) {
+        if (steps + k != skip) {
+            cdd_extract_step(steps + k, steps[k].first, steps[k].last, dbm, dim);
+        }
+    }
+}
+
+/* Returns true if the part of \a base within child \a k of \a step
+ * is empty or only reaches \a bottom in \a cdd. Only this slab has
+ * to be checked when the interval of \a step is widened by child \a k,
+ * as the zone of the current interval is known to be inside.
+ */
+static bool cdd_extract_slab(ddNode* cdd, const ExtractStep* step, int32_t k, const raw_t* base, raw_t* slab,
+                             uint32_t dim, ddNode* bottom)
+{
+    dbm_copy(slab, base, dim);
+    return !cdd_extract_step(step, k, k, slab, dim) || cdd_contains_bottom(cdd, slab, 0, dim, bottom);
+}
+
+ddNode* cdd_extract_dbm_greedy(ddNode* cdd, raw_t* dbm, uint32_t dim)
+{
+    ExtractStep *steps, *step;
+    LevelInfo* info;
+    ddNode *node, *zone, *result;
+    ddNode** children;
+    uintptr_t neg;
+    int32_t depth;
+    raw_t *base, *slab;
+
+    /* The path has at most one step per clock difference, and the
+     * steps share their allocation with the two zones used below */
+    steps = malloc(cdd_clocknum * (cdd_clocknum - 1) / 2 * sizeof(ExtractStep) + 2 * dim * dim * sizeof(raw_t));
+    if (steps == NULL) {
+        cdd_error(CDD_MEMORY);
+        return NULL;
+    }
+    base = (raw_t*)(steps + cdd_clocknum * (cdd_clocknum - 1) / 2);
+    slab = base + dim * dim;
+
+    /* Follow the same path as cdd_extract_dbm() */
+    node = cdd;
+    depth = 0;
+    while (!cdd_isterminal(node) && cdd_node_type(node) != TYPE_BDD) {
+        info = cdd_info(node);
+        assert(info->clock1 < dim);
+        assert(info->clock2 < dim);
+
+        step = steps + depth++;
+        step->info = info;
+        step->bnd = cdd_node_bnd(node);
+        children = cdd_node_child(node);
+        neg = cdd_mask(node);
+        step->n = cdd_node_len(node);
+        for (step->first = 0; IS_FALSE(cdd_neg_cond(children[step->first], neg)); step->first++)
+            ;
+        step->last = step->first;
+        node = cdd_neg_cond(children[step->first], neg);
+    }
+
+    /* Widen the interval of each level into its neighbours as long as
+     * the zone stays inside the part of the diagram ending in node.
+     * The other levels are fixed meanwhile, so their zone is computed
+     * once per level and each widening only checks the added slab.
+     */
+    if (cdd_contains_reserve(1, dim) < 0) {
+        free(steps);
+        return NULL;
+    }
+    opid++;
+    for (step = steps; step < steps + depth; step++) {
+        if (step->first == 0 && step->last == step->n - 1) {
+            continue;
+        }
+        cdd_extract_steps(steps, depth, step, base, dim);
+        while (step->first > 0 && cdd_extract_slab(cdd, step, step->first - 1, base, slab, dim, node)) {
+            step->first--;
+        }
+        while (step->last < step->n - 1 && cdd_extract_slab(cdd, step, step->last + 1, base, slab, dim, node)) {
+            step->last++;
+        }
+    }
+    cdd_extract_steps(steps, depth, NULL, dbm, dim);
+    free(steps);
+    assert(dbm_isValid(dbm, dim));
+
+    zone = cdd_from_dbm(dbm, dim);
+    cdd_ref(zone);
+
+    result = cdd_and(cdd, cdd_neg(zone));
+    cdd_deref(zone);
+
+    return result;
+}
+
 ddNode* cdd_extract_bdd(ddNode* cdd, uint32_t dim)
 {
     cdd_iterator it;
@@ -1204,6 +3694,125 @@ ddNode* cdd_extract_bdd(ddNode* cdd, uint32_t dim)
     return cddtrue;
 }
 
+struct cdd_zone_frame_
+{
+    cdd_iterator it;
+    LevelInfo* info;
+};
+
+/* The zone iterator keeps an explicit stack of the CDD nodes on the
+ * current path. Frame d iterates the children of the d'th node and
+ * dbms[d] holds the zone of the path above that node, such that
+ * dbms[d + 1] is dbms[d] constrained to the interval of the current
+ * child. Paths are cut as soon as their zone becomes empty.
+ */
+void cdd_zone_iterator_init(cdd_zone_iterator* it, ddNode* cdd, uint32_t dim)
+{
+    // The frames point into the nodes, so their levels must stay put
+    cdd_reorder_hold();
+    it->dim = dim;
+    it->depth = 0;
+    it->capacity = 0;
+    it->pending = cdd;
+    it->frames = NULL;
+    it->dbms = malloc(dim * dim * sizeof(raw_t));
+    if (it->dbms == NULL) {
+        cdd_error(CDD_MEMORY);
+        it->pending = NULL;
+        return;
+    }
+    dbm_init(it->dbms, dim);
+}
+
+static bool cdd_zone_iterator_grow(cdd_zone_iterator* it)
+{
+    uint32_t size = it->dim * it->dim;
+    int32_t capacity = it->capacity == 0 ? 8 : 2 * it->capacity;
+    cdd_zone_frame* frames;
+    raw_t* dbms;
+
+    frames = realloc(it->frames, capacity * sizeof(cdd_zone_frame));
+    if (frames == NULL) {
+        return false;
+    }
+    it->frames = frames;
+    dbms = realloc(it->dbms, (capacity + 1) * size * sizeof(raw_t));
+    if (dbms == NULL) {
+        return false;
+    }
+    it->dbms = dbms;
+    it->capacity = capacity;
+    return true;
+}
+
+int32_t cdd_zone_iterator_next(cdd_zone_iterator* it, raw_t* dbm, ddNode** bdd)
+{
+    uint32_t size = it->dim * it->dim;
+    cdd_zone_frame* frame;
+    ddNode* node;
+    raw_t* zone;
+
+    for (;;) {
+        node = it->pending;
+        if (node != NULL) {
+            it->pending = NULL;
+            zone = it->dbms + it->depth * size;
+            if (cdd_isterminal(node) || cdd_node_type(node) == TYPE_BDD) {
+                if (IS_FALSE(node)) {
+                    continue;
+                }
+                dbm_copy(dbm, zone, it->dim);
+                *bdd = cdd_isterminal(node) ? cddtrue : node;
+                return 1;
+            }
+            if (it->depth == it->capacity && !cdd_zone_iterator_grow(it)) {
+                cdd_error(CDD_MEMORY);
+                it->depth = 0;
+                return 0;
+            }
+            frame = it->frames + it->depth++;
+            frame->info = cdd_info(node);
+            assert(frame->info->clock1 < it->dim);
+            assert(frame->info->clock2 < it->dim);
+            cdd_it_init(frame->it, node);
+        }
+
+        /* Advance the innermost frame to its next consistent child */
+        if (it->depth == 0) {
+            return 0;
+        }
+        frame = it->frames + it->depth - 1;
+        zone = it->dbms + it->depth * size;
+        for (; !cdd_it_atend(frame->it); cdd_it_next(frame->it)) {
+            if (IS_FALSE(cdd_it_child(frame->it))) {
+                continue;
+            }
+            dbm_copy(zone, zone - size, it->dim);
+            if (cdd_constrain2(zone, it->dim, frame->info->clock1, frame->info->clock2, cdd_it_lower(frame->it),
+                               cdd_it_upper(frame->it))) {
+                it->pending = cdd_it_child(frame->it);
+                cdd_it_next(frame->it);
+                break;
+            }
+        }
+        if (it->pending == NULL) {
+            it->depth--;
+        }
+    }
+}
+
+void cdd_zone_iterator_done(cdd_zone_iterator* it)
+{
+    cdd_reorder_release();
+    free(it->frames);
+    free(it->dbms);
+    it->frames = NULL;
+    it->dbms = NULL;
+    it->depth = 0;
+    it->capacity = 0;
+    it->pending = NULL;
+}
+
 void cdd_mark_clock(int32_t* vec, int32_t c)
 {
     int32_t n;
@@ -1485,9 +4094,13 @@ ddNode* cdd_reduce(ddNode* node)
     struct edge edges[cdd_clocknum * cdd_clocknum - cdd_clocknum];
     struct node fifo[cdd_clocknum + 1];
     uint32_t queued[bits2intsize(cdd_clocknum)];
+    ddNode* res;
+    CDD_TRACE_BEGIN(span, node, NULL);
 
     cdd_tarjan_init(&graph, cdd_clocknum, dist, count, edges, fifo, queued);
-    return cdd_tarjan_reduce_rec(node, &graph);
+    res = cdd_tarjan_reduce_rec(node, &graph);
+    CDD_TRACE_END(span, "cdd_reduce", -1, res);
+    return res;
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -1501,9 +4114,12 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
     int32_t rmask;
     int32_t mask;
     Elem* top;
-    Elem* lp;
-    Elem* rp;
     Elem* first;
+    const raw_t* lb;
+    const raw_t* rb;
+    ddNode** lc;
+    ddNode** rc;
+    int32_t li, ri;
     ddNode* ll;
     ddNode* lh;
     ddNode* rl;
@@ -1511,7 +4127,7 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
     ddNode* n;
     ddNode* prev;
     ddNode* res = NULL;
-    raw_t bnd;
+    raw_t bnd, inf = INF;
     raw_t lower;
     LevelInfo* info;
 
@@ -1575,7 +4191,7 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
 
     /* The operation is symmetric; normalise for better cache performance.
      */
-    if (l > r) {
+    if (cdd_node_key(l) > cdd_node_key(r)) {
         n = l;
         l = r;
         r = n;
@@ -1585,6 +4201,7 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
      */
     entry = CddCache_lookup(&applycache, APPLYHASH(l, r, applyop));
     if (entry->a == l && entry->b == r && entry->c == applyop) {
+        CddCache_hit(&applycache);
         if (cdd_rglr(entry->res)->ref == 0) {
             cdd_reclaim(entry->res);
         }
@@ -1609,18 +4226,21 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
          */
         top = cdd_refstacktop;
         if (l->level <= r->level) {
-            lp = cdd_node(l)->elem;
+            lb = cdd_node_bnd(l);
+            lc = cdd_node_child(l);
         } else {
-            lp = cdd_refstacktop;
-            cdd_push(l, INF);
+            lb = &inf;
+            lc = &l;
         }
 
         if (l->level >= r->level) {
-            rp = cdd_node(r)->elem;
+            rb = cdd_node_bnd(r);
+            rc = cdd_node_child(r);
         } else {
-            rp = cdd_refstacktop;
-            cdd_push(r, INF);
+            rb = &inf;
+            rc = &r;
         }
+        li = ri = 0;
 
         /*
          * Do recursion
@@ -1632,23 +4252,23 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
          * upper bound since we know that all children to the left of
          * the current child are on inconsistent paths.
          */
-        bnd = minimum(lp->bnd, rp->bnd);
+        bnd = minimum(lb[li], rb[ri]);
         cdd_tarjan_push(graph, info->clock1, info->clock2, bnd);
         while (!cdd_tarjan_consistent(graph)) {
             cdd_tarjan_pop(graph, info->clock1);
-            lp += (lp->bnd == bnd);
-            rp += (rp->bnd == bnd);
-            bnd = minimum(lp->bnd, rp->bnd);
+            li += (lb[li] == bnd);
+            ri += (rb[ri] == bnd);
+            bnd = minimum(lb[li], rb[ri]);
             if (bnd == dbm_LS_INFINITY) {
                 cdd_refstacktop = top;
-                return cdd_apply_reduce_rec(cdd_neg_cond(lp->child, lmask), cdd_neg_cond(rp->child, rmask), graph);
+                return cdd_apply_reduce_rec(cdd_neg_cond(lc[li], lmask), cdd_neg_cond(rc[ri], rmask), graph);
             }
             cdd_tarjan_push(graph, info->clock1, info->clock2, bnd);
         }
 
         /* Do first recursion - check whether first edge is negated.
          */
-        prev = cdd_apply_reduce_rec(cdd_neg_cond(lp->child, lmask), cdd_neg_cond(rp->child, rmask), graph);
+        prev = cdd_apply_reduce_rec(cdd_neg_cond(lc[li], lmask), cdd_neg_cond(rc[ri], rmask), graph);
         cdd_ref(prev);
         mask = cdd_mask(prev);
         cdd_tarjan_pop(graph, info->clock1);
@@ -1659,14 +4279,14 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
          * inconsistent (in which case all reamining children are
          * inconsistent as well).
          */
-        lp += (lp->bnd == bnd);
-        rp += (rp->bnd == bnd);
+        li += (lb[li] == bnd);
+        ri += (rb[ri] == bnd);
         lower = bnd;
-        bnd = minimum(lp->bnd, rp->bnd);
+        bnd = minimum(lb[li], rb[ri]);
         cdd_tarjan_push(graph, info->clock2, info->clock1, bnd_l2u(lower));
         while (bnd < INF && cdd_tarjan_consistent(graph)) {
             cdd_tarjan_push(graph, info->clock1, info->clock2, bnd);
-            n = cdd_apply_reduce_rec(cdd_neg_cond(lp->child, lmask), cdd_neg_cond(rp->child, rmask), graph);
+            n = cdd_apply_reduce_rec(cdd_neg_cond(lc[li], lmask), cdd_neg_cond(rc[ri], rmask), graph);
             cdd_tarjan_pop(graph, info->clock1);
             cdd_tarjan_pop(graph, info->clock2);
 
@@ -1676,10 +4296,10 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
                 cdd_ref(prev);
             }
 
-            lp += (lp->bnd == bnd);
-            rp += (rp->bnd == bnd);
+            li += (lb[li] == bnd);
+            ri += (rb[ri] == bnd);
             lower = bnd;
-            bnd = minimum(lp->bnd, rp->bnd);
+            bnd = minimum(lb[li], rb[ri]);
 
             cdd_tarjan_push(graph, info->clock2, info->clock1, bnd_l2u(lower));
         }
@@ -1688,7 +4308,7 @@ static ddNode* cdd_apply_reduce_rec(ddNode* l, ddNode* r, struct tarjan* graph)
          * only if the path is consistent.
          */
         if (bnd == INF && cdd_tarjan_consistent(graph)) {
-            n = cdd_apply_reduce_rec(cdd_neg_cond(lp->child, lmask), cdd_neg_cond(rp->child, rmask), graph);
+            n = cdd_apply_reduce_rec(cdd_neg_cond(lc[li], lmask), cdd_neg_cond(rc[ri], rmask), graph);
             if (n != prev) {
                 cdd_push(cdd_neg_cond(prev, mask), lower);
                 prev = n;
@@ -1754,13 +4374,16 @@ ddNode* cdd_apply_reduce(ddNode* l, ddNode* h, int32_t op)
     struct node fifo[cdd_clocknum + 1];
     uint32_t queued[bits2intsize(cdd_clocknum)];
 
+    cdd_reorder_point();
+    CDD_TRACE_BEGIN(span, l, h);
     cdd_tarjan_init(&graph, cdd_clocknum, dist, count, edges, fifo, queued);
 
     applyop = op;
     res = cdd_apply_reduce_rec(l, h, &graph);
     if (cdd_errorcond) {
         cdd_error(cdd_errorcond);
-        return NULL;
+        res = NULL;
     }
+    CDD_TRACE_END(span, "cdd_apply_reduce", op, res);
     return res;
 }
@@ -1 +1,2 @@
 #cmakedefine MULTI_TERMINAL @MULTI_TERMINAL@
+#cmakedefine CDD_TRACE @CDD_TRACE@
@@ -14,6 +14,11 @@
 #include <dbm/fed.h>
 #include <dbm/print.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #define ADBM(NAME, DIM) raw_t* NAME = allocDBM(DIM)
 
 /* Allocate a DBM. */
@@ -43,6 +48,24 @@ cdd::cdd(ddNode* r)
 
 cdd::~cdd() { cdd_rec_deref(root); }
 
+cdd cdd_and_n(const cdd* parts, size_t k)
+{
+    std::vector<ddNode*> handles(k);
+    for (size_t i = 0; i < k; ++i) {
+        handles[i] = parts[i].handle();
+    }
+    return cdd(cdd_and_n(handles.data(), k));
+}
+
+cdd cdd_or_n(const cdd* parts, size_t k)
+{
+    std::vector<ddNode*> handles(k);
+    for (size_t i = 0; i < k; ++i) {
+        handles[i] = parts[i].handle();
+    }
+    return cdd(cdd_or_n(handles.data(), k));
+}
+
 cdd& cdd::operator=(const cdd& r)
 {
     if (root != r.root) {
@@ -85,37 +108,23 @@ extraction_result cdd_extract_bdd_and_dbm(const cdd& state)
 /**
  * Perform the delay operation on a CDD.
  *
- * <p>The delay is performed by extracting all DBMs (and their
- * corresponding BDD part), delaying the DBMs individually,
- * and then compose the delayed DBMs back together with their
- * BDD parts.</p>
+ * <p>The delay is performed on the structure of the diagram: upper
+ * bounds on the clocks are removed and the constraints they implied
+ * between pairs of clocks are kept.</p>
  *
  * @param cdd a CDD
  * @return the delayed CDD.
+ * @see cdd_delay(ddNode*)
  */
 cdd cdd_delay(const cdd& state)
 {
     // First some trivial cases.
     if (cdd_isterminal(state.handle()))
         return state;
-    if (cdd_info(state.handle())->type == TYPE_BDD)
+    if (cdd_node_type(state.handle()) == TYPE_BDD)
         return state;
 
-    cdd copy = state;
-    cdd res = cdd_false();
-    ADBM(dbm, cdd_clocknum);
-    while (!cdd_isterminal(copy.handle()) && cdd_info(copy.handle())->type != TYPE_BDD) {
-        copy = cdd_reduce(copy);
-        cdd bottom = cdd_extract_bdd(copy, cdd_clocknum);
-        copy = cdd_extract_dbm(copy, dbm, cdd_clocknum);
-        copy = cdd_reduce(cdd_remove_negative(copy));
-        dbm_up(dbm, cdd_clocknum);
-        cdd fixed_cdd = cdd(dbm, cdd_clocknum);
-        fixed_cdd &= bottom;
-        res |= fixed_cdd;
-    }
-    free(dbm);
-    return res;
+    return cdd(cdd_delay(state.handle()));
 }
 
 /**
@@ -125,100 +134,336 @@ cdd cdd_delay(const cdd& state)
  */
 cdd cdd_from_fed(const dbm::fed_t& fed)
 {
-    dbm::fed_t copy = dbm::fed_t(fed);
-    cdd res = cdd_false();
+    std::vector<const raw_t*> dbms;
     for (auto& zone : fed) {
-        res |= cdd(zone.const_dbm(), cdd_clocknum);
+        dbms.push_back(zone.const_dbm());
     }
-    return res;
+    return cdd(cdd_from_dbms(dbms.data(), dbms.size(), cdd_clocknum));
 }
 
 /**
- * Get the timed predecessor of the given (bad) target dbm and target bdd that cannot be
- * saved (i.e. reached) by delaying into \a safe.
+ * Restrict a BDD to a value of the boolean variable at a level no larger than its top level.
+ * @param bdd a cdd with only BDD nodes
+ * @param level the level of the boolean variable
+ * @param value the value of the boolean variable
+ * @return the cofactor of \a bdd for \a level being \a value.
+ */
+static cdd cdd_cofactor(const cdd& bdd, int32_t level, bool value)
+{
+    ddNode* node = bdd.handle();
+    if (cdd_isterminal(node) || cdd_rglr(node)->level != level) {
+        return bdd;
+    }
+    return cdd(value ? bdd_high(node) : bdd_low(node));
+}
+
+/**
+ * A timed predecessor computation of one target zone for one cube of boolean valuations.
  *
- * <p>If there is an overlap between \a target and \a safe, the overlap is considered
- * to be saved.</p>
- * @param dbm_target the target dbm
- * @param bdd_target the target bdd
- * @param safe the safe cdd
- * @return a cdd containing states that can delay into \a target without reaching \a safe.
+ * <p>The zones are kept one after another in plain vectors rather than in federations:
+ * UDBM allocates federations from pools shared by all threads, while the DBM functions
+ * only work on the memory they are given. Computing \a result thus needs neither the CDD
+ * kernel nor the UDBM allocators, so the items can be computed on any thread.</p>
  */
-cdd cdd_predt_dbm(raw_t* dbm_target, cdd bdd_target, const cdd& safe)
+struct predt_work
 {
-    cdd result = cdd_false();
+    std::vector<raw_t> bad;     ///< The target zone.
+    std::vector<raw_t> good;    ///< The safe zones, if \a saved.
+    bool saved;                 ///< Whether the safe part overlaps, otherwise the result is the past of \a bad.
+    cdd cube;                   ///< The boolean valuations the result holds for.
+    std::vector<raw_t> result;  ///< The zones of the timed predecessor.
+};
 
-    // Check whether the safe has an overlapping BDD part with the target.
-    cdd good_part_with_fitting_bools = bdd_target & safe;
-    if (good_part_with_fitting_bools != cdd_false()) {
-        // For each possible combination of boolean valuations,
-        // compute the part of safe that overlaps with it.
-        for (auto i = 0u; i < (1u << cdd_varnum); ++i) {
-            cdd all_booleans = cdd_true();
-            for (auto j = 0u; j < cdd_varnum; ++j) {
-                bool current = (i & 1 << j) != 0;
-                if (current) {
-                    all_booleans &= cdd_bddvarpp(bdd_start_level + j);
-                } else {
-                    all_booleans &= cdd_bddnvarpp(bdd_start_level + j);
-                }
-            }
+/**
+ * Add a zone to a list of zones, unless it is included in one of them. The zones included
+ * in the new zone are removed.
+ * @param zones the zones, one after another
+ * @param dbm a closed, non-empty zone
+ * @param dim the dimension of the zones
+ */
+static void cdd_predt_add(std::vector<raw_t>& zones, const raw_t* dbm, uint32_t dim)
+{
+    uint32_t size = dim * dim;
+    size_t n = 0;
+    for (size_t i = 0; i < zones.size(); i += size) {
+        if (dbm_isSubsetEq(dbm, zones.data() + i, dim)) {
+            return;
+        }
+        if (!dbm_isSubsetEq(zones.data() + i, dbm, dim)) {
+            std::copy(zones.begin() + i, zones.begin() + i + size, zones.begin() + n);
+            n += size;
+        }
+    }
+    zones.resize(n);
+    zones.insert(zones.end(), dbm, dbm + size);
+}
 
-            // No need to test combinations that don't satisfy the bad part.
-            if (cdd_equiv(all_booleans & bdd_target, cdd_false())) {
+/**
+ * Add the difference of two zones to a list of zones. The difference is split into
+ * disjoint zones, one for each constraint of \a b that cuts \a a.
+ * @param zones the zones, one after another
+ * @param a a closed, non-empty zone
+ * @param b a closed, non-empty zone
+ * @param dim the dimension of the zones
+ */
+static void cdd_predt_subtract(std::vector<raw_t>& zones, const raw_t* a, const raw_t* b, uint32_t dim)
+{
+    std::vector<raw_t> rest(a, a + dim * dim);
+    std::vector<raw_t> piece(dim * dim);
+    for (uint32_t i = 0; i < dim; ++i) {
+        for (uint32_t j = 0; j < dim; ++j) {
+            if (i == j || b[i * dim + j] >= rest[i * dim + j]) {
                 continue;
             }
+            dbm_copy(piece.data(), rest.data(), dim);
+            if (dbm_constrain1(piece.data(), dim, j, i, dbm_negRaw(b[i * dim + j]))) {
+                cdd_predt_add(zones, piece.data(), dim);
+            }
+            if (!dbm_constrain1(rest.data(), dim, i, j, b[i * dim + j])) {
+                return;
+            }
+        }
+    }
+}
 
-            // Paranoia check.
-            assert(!cdd_eval_false(all_booleans & bdd_target));
-
-            auto bad_fed = dbm::fed_t{dbm_target, (uint32_t)cdd_clocknum};
-            ADBM(dbm_good, cdd_clocknum);
-            cdd good_copy = good_part_with_fitting_bools & all_booleans;
-
-            if (!cdd_eval_false(good_copy)) {
-                auto good_fed = dbm::fed_t{(uint32_t)cdd_clocknum};
-                while (!cdd_isterminal(good_copy.handle()) && cdd_info(good_copy.handle())->type != TYPE_BDD) {
-                    extraction_result res_good = cdd_extract_bdd_and_dbm(good_copy);
-                    good_copy = cdd_reduce(cdd_remove_negative(res_good.CDD_part));
-                    free(dbm_good);
-                    dbm_good = res_good.dbm;
-                    cdd bdd_good = res_good.BDD_part;
-                    good_fed.add(dbm_good, cdd_clocknum);
-                }
+/**
+ * Compute the states that can delay into a target zone without passing through a safe zone:
+ * <pre>(bad↓ \ good↓) ∪ ((bad ∩ good↓) \ good)↓</pre>
+ * @param zones the zones the result is added to, one after another
+ * @param bad the target zone
+ * @param good the safe zone
+ * @param dim the dimension of the zones
+ */
+static void cdd_predt_zone(std::vector<raw_t>& zones, const raw_t* bad, const raw_t* good, uint32_t dim)
+{
+    uint32_t size = dim * dim;
+    std::vector<raw_t> bad_past(bad, bad + size);
+    std::vector<raw_t> good_past(good, good + size);
+    dbm_down(bad_past.data(), dim);
+    dbm_down(good_past.data(), dim);
+    cdd_predt_subtract(zones, bad_past.data(), good_past.data(), dim);
+
+    std::vector<raw_t> overlap(bad, bad + size);
+    if (dbm_intersection(overlap.data(), good_past.data(), dim)) {
+        std::vector<raw_t> pieces;
+        cdd_predt_subtract(pieces, overlap.data(), good, dim);
+        for (size_t i = 0; i < pieces.size(); i += size) {
+            dbm_down(pieces.data() + i, dim);
+            cdd_predt_add(zones, pieces.data() + i, dim);
+        }
+    }
+}
+
+/**
+ * Compute the result of a work item. The target zone is convex, so avoiding all safe zones
+ * is avoiding each of them: the result is the intersection of the results for each zone.
+ * @param work the work item.
+ * @param dim the dimension of the zones
+ */
+static void cdd_predt_work(predt_work& work, uint32_t dim)
+{
+    uint32_t size = dim * dim;
+    if (!work.saved) {
+        work.result = work.bad;
+        dbm_down(work.result.data(), dim);
+        return;
+    }
 
-                // If good_fed is empty, good_copy did not contain any DBM. This has the interpretation
-                // of an unbounded DBM.
-                if (good_fed.isEmpty()) {
-                    dbm_init(dbm_good, cdd_clocknum);
-                    good_fed.add(dbm_good, cdd_clocknum);
+    cdd_predt_zone(work.result, work.bad.data(), work.good.data(), dim);
+    std::vector<raw_t> next, meet(size);
+    for (size_t k = size; k < work.good.size() && !work.result.empty(); k += size) {
+        next.clear();
+        cdd_predt_zone(next, work.bad.data(), work.good.data() + k, dim);
+        std::vector<raw_t> both;
+        for (size_t i = 0; i < work.result.size(); i += size) {
+            for (size_t j = 0; j < next.size(); j += size) {
+                dbm_copy(meet.data(), work.result.data() + i, dim);
+                if (dbm_intersection(meet.data(), next.data() + j, dim)) {
+                    cdd_predt_add(both, meet.data(), dim);
                 }
+            }
+        }
+        work.result.swap(both);
+    }
+}
 
-                auto pred_fed = bad_fed.predt(good_fed);
-                result |= cdd_from_fed(pred_fed) & all_booleans;
-
-            } else {
-                // For all boolean valuations we did not reach with our safe CDD, we take the past of the
-                // current target DBM.
-                ADBM(local, cdd_clocknum);
-                dbm_copy(local, dbm_target, cdd_clocknum);
-                dbm_down(local, cdd_clocknum);
-                cdd past = cdd(local, cdd_clocknum) & all_booleans;
-                result |= past;
-                free(local);
+/**
+ * The safe zones overlapping a target zone, each with the boolean valuations it holds for.
+ */
+struct predt_good
+{
+    std::vector<raw_t> dbms;  ///< The zones, one after another.
+    std::vector<cdd> bdds;    ///< The BDD part of each zone.
+};
+
+/**
+ * Collect the timed predecessor computations of a target dbm for every cube of boolean
+ * valuations on which neither the target bdd nor the safe part depend anymore.
+ *
+ * <p>BDD nodes only have BDD nodes below them, so the variable to split on is found at the
+ * top of the target bdd and of the BDD parts of the safe zones.</p>
+ *
+ * @param dbm_target the target dbm
+ * @param bdd_target the cofactor of the target bdd for \a cube
+ * @param good the safe zones overlapping the target bdd, with their BDD parts cofactored for
+ *      \a cube and the zones whose BDD part became false left out
+ * @param cube the boolean valuations fixed so far
+ * @param work the vector the work items are added to
+ */
+static void cdd_predt_cubes(const raw_t* dbm_target, const cdd& bdd_target, const predt_good& good,
+                            const cdd& cube, std::vector<predt_work>& work)
+{
+    uint32_t size = cdd_clocknum * cdd_clocknum;
+
+    // No need to test valuations that don't satisfy the bad part.
+    if (bdd_target == cdd_false()) {
+        return;
+    }
+
+    // Split on the first boolean variable either side still depends on.
+    int32_t level = -1;
+    if (!cdd_isterminal(bdd_target.handle())) {
+        level = cdd_rglr(bdd_target.handle())->level;
+    }
+    for (const cdd& bdd : good.bdds) {
+        if (!cdd_isterminal(bdd.handle()) && (level == -1 || cdd_rglr(bdd.handle())->level < level)) {
+            level = cdd_rglr(bdd.handle())->level;
+        }
+    }
+    if (level != -1) {
+        int32_t var = cdd_level2var[level];
+        for (bool value : {true, false}) {
+            predt_good cofactor;
+            for (size_t i = 0; i < good.bdds.size(); ++i) {
+                cdd bdd = cdd_cofactor(good.bdds[i], level, value);
+                if (bdd != cdd_false()) {
+                    cofactor.dbms.insert(cofactor.dbms.end(), good.dbms.begin() + i * size,
+                                         good.dbms.begin() + (i + 1) * size);
+                    cofactor.bdds.push_back(bdd);
+                }
             }
-            free(dbm_good);
+            cdd_predt_cubes(dbm_target, cdd_cofactor(bdd_target, level, value), cofactor,
+                            cube & (value ? cdd_bddvarpp(var) : cdd_bddnvarpp(var)), work);
         }
+        return;
+    }
 
+    std::vector<raw_t> bad(dbm_target, dbm_target + size);
+    if (!good.bdds.empty()) {
+        // All BDD parts left are true, as they do not depend on any variable.
+        work.push_back(predt_work{std::move(bad), good.dbms, true, cube, {}});
+    } else {
+        // For all boolean valuations we did not reach with our safe CDD, we take the past of the
+        // current target DBM.
+        work.push_back(predt_work{std::move(bad), {}, false, cube, {}});
+    }
+}
+
+/**
+ * Collect the timed predecessor computations of the given (bad) target dbm and target bdd.
+ *
+ * @param dbm_target the target dbm
+ * @param bdd_target the target bdd
+ * @param safe the safe cdd
+ * @param work the vector the work items are added to
+ */
+static void cdd_predt_collect(const raw_t* dbm_target, const cdd& bdd_target, const cdd& safe,
+                              std::vector<predt_work>& work)
+{
+    // Check whether the safe has an overlapping BDD part with the target.
+    cdd good_part_with_fitting_bools = bdd_target & safe;
+
+    // The cubes are split on levels, so the levels must stay put until all are collected.
+    cdd_reorder_hold();
+    if (good_part_with_fitting_bools != cdd_false()) {
+        // Split the overlap into zones once. A BDD part without clock constraints is one
+        // unbounded zone.
+        predt_good good;
+        std::vector<raw_t> zone(cdd_clocknum * cdd_clocknum);
+        ddNode* bdd_good;
+        cdd_zone_iterator it;
+        cdd_zone_iterator_init(&it, good_part_with_fitting_bools.handle(), cdd_clocknum);
+        while (cdd_zone_iterator_next(&it, zone.data(), &bdd_good)) {
+            good.dbms.insert(good.dbms.end(), zone.begin(), zone.end());
+            good.bdds.push_back(cdd(bdd_good));
+        }
+        cdd_zone_iterator_done(&it);
+
+        // For each cube of boolean valuations, compute the part of safe that overlaps with it.
+        cdd_predt_cubes(dbm_target, bdd_target, good, cdd_true(), work);
     } else {
         // Safe does not have an overlapping part with the target BDD.
         // So the complete past of this DBM is bad.
-        dbm_down(dbm_target, cdd_clocknum);
-        cdd past = cdd(dbm_target, cdd_clocknum) & bdd_target;
-        result |= past;
+        work.push_back(predt_work{std::vector<raw_t>(dbm_target, dbm_target + cdd_clocknum * cdd_clocknum), {}, false,
+                                  bdd_target, {}});
+    }
+    cdd_reorder_release();
+}
+
+/**
+ * Compute the work items, on \a num_threads threads if more than one, and join their results.
+ *
+ * @param work the work items
+ * @param num_threads the number of threads to use
+ * @return the union of the results of \a work.
+ */
+static cdd cdd_predt_run(std::vector<predt_work>& work, uint32_t num_threads)
+{
+    uint32_t dim = cdd_clocknum;
+    num_threads = std::min<size_t>(num_threads, work.size());
+    if (num_threads > 1) {
+        // The workers only use the DBM functions; all diagrams are built by this thread.
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> workers;
+        for (auto i = 0u; i < num_threads; ++i) {
+            workers.emplace_back([&work, &next, dim] {
+                for (size_t k; (k = next++) < work.size();) {
+                    cdd_predt_work(work[k], dim);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    } else {
+        for (auto& item : work) {
+            cdd_predt_work(item, dim);
+        }
     }
 
-    return result;
+    std::vector<cdd> parts;
+    std::vector<const raw_t*> dbms;
+    parts.reserve(work.size());
+    for (auto& item : work) {
+        dbms.clear();
+        for (size_t i = 0; i < item.result.size(); i += dim * dim) {
+            dbms.push_back(item.result.data() + i);
+        }
+        parts.push_back(cdd(cdd_from_dbms(dbms.data(), dbms.size(), dim)) & item.cube);
+    }
+    return cdd_or_n(parts.data(), parts.size());
+}
+
+/**
+ * Get the timed predecessor of the given (bad) target dbm and target bdd that cannot be
+ * saved (i.e. reached) by delaying into \a safe.
+ *
+ * <p>If there is an overlap between \a target and \a safe, the overlap is considered
+ * to be saved.</p>
+ *
+ * <p>The boolean valuations are enumerated as cubes by splitting only on the variables the
+ * target bdd and the safe part depend on, so the cost follows the size of the diagrams
+ * rather than the number of boolean variables.</p>
+ * @param dbm_target the target dbm
+ * @param bdd_target the target bdd
+ * @param safe the safe cdd
+ * @return a cdd containing states that can delay into \a target without reaching \a safe.
+ */
+cdd cdd_predt_dbm(raw_t* dbm_target, cdd bdd_target, const cdd& safe)
+{
+    std::vector<predt_work> work;
+    cdd_predt_collect(dbm_target, bdd_target, safe, work);
+    return cdd_predt_run(work, 1);
 }
 
 /**
@@ -231,7 +476,22 @@ cdd cdd_predt_dbm(raw_t* dbm_target, cdd bdd_target, const cdd& safe)
  * @param safe the safe cdd
  * @return a cdd containing states that can delay into \a target without reaching \a safe.
  */
-cdd cdd_predt(const cdd& target, const cdd& safe)
+cdd cdd_predt(const cdd& target, const cdd& safe) { return cdd_predt(target, safe, 1); }
+
+/**
+ * Get the timed predecessor of the given (bad) \a target state that cannot be
+ * saved (i.e. reached) by delaying into \a safe, using several threads.
+ *
+ * <p>The target is split into zones and boolean cubes by the calling thread. The
+ * timed predecessor of each piece is computed on one of \a num_threads threads, which
+ * only use the DBM functions on zones of their own and neither the CDD kernel nor the
+ * UDBM allocators, after which the calling thread joins the results in one n-ary union.</p>
+ * @param target the target cdd
+ * @param safe the safe cdd
+ * @param num_threads the number of threads to use
+ * @return a cdd containing states that can delay into \a target without reaching \a safe.
+ */
+cdd cdd_predt(const cdd& target, const cdd& safe, uint32_t num_threads)
 {
     // First some trivial cases.
     if (target == cdd_false())
@@ -239,29 +499,27 @@ cdd cdd_predt(const cdd& target, const cdd& safe)
     if (safe == cdd_true())
         return cdd_false();
 
-    cdd allThatKillsUs = cdd_false();
-    cdd copy = target;
+    CDD_TRACE_BEGIN(span, target.handle(), safe.handle());
+    std::vector<predt_work> work;
     ADBM(dbm_target, cdd_clocknum);
 
-    if (cdd_isterminal(target.handle()) || cdd_info(target.handle())->type == TYPE_BDD) {
+    if (cdd_isterminal(target.handle()) || cdd_node_type(target.handle()) == TYPE_BDD) {
         dbm_init(dbm_target, cdd_clocknum);
-        cdd result = cdd_predt_dbm(dbm_target, target, safe);
-        free(dbm_target);
-        return result;
-    }
-
-    // Split target into DBMs.
-    while (!cdd_isterminal(copy.handle()) && cdd_info(copy.handle())->type != TYPE_BDD) {
-        extraction_result res = cdd_extract_bdd_and_dbm(copy);
-        copy = cdd_reduce(cdd_remove_negative(res.CDD_part));
-        free(dbm_target);
-        dbm_target = res.dbm;
-        cdd bdd_target = res.BDD_part;
-
-        allThatKillsUs |= cdd_predt_dbm(dbm_target, bdd_target, safe);
+        cdd_predt_collect(dbm_target, target, safe, work);
+    } else {
+        // Split target into DBMs.
+        ddNode* bdd_target;
+        cdd_zone_iterator it;
+        cdd_zone_iterator_init(&it, target.handle(), cdd_clocknum);
+        while (cdd_zone_iterator_next(&it, dbm_target, &bdd_target)) {
+            cdd_predt_collect(dbm_target, cdd(bdd_target), safe, work);
+        }
+        cdd_zone_iterator_done(&it);
     }
     free(dbm_target);
-    return allThatKillsUs;
+    cdd res = cdd_predt_run(work, num_threads);
+    CDD_TRACE_END(span, "cdd_predt", -1, res.handle());
+    return res;
 }
 
 /**
@@ -274,50 +532,41 @@ cdd cdd_predt(const cdd& target, const cdd& safe)
  */
 cdd cdd_delay_invariant(const cdd& state, const cdd& invar)
 {
-    cdd res = cdd_delay(state);
-    res &= invar;
-    return res;
+    // First some trivial cases.
+    if (cdd_isterminal(state.handle()) || cdd_node_type(state.handle()) == TYPE_BDD)
+        return state & invar;
+
+    return cdd(cdd_delay_invariant(state.handle(), invar.handle()));
 }
 
 /**
  * Perform the inverse delay operation on a CDD.
  *
- * <p>The inverse delay is performed by extracting all DBMs (and their
- * corresponding BDD part), delaying the DBMs individually,
- * and then compose the delayed DBMs back together with their
- * BDD parts.</p>
+ * <p>The inverse delay is performed on the structure of the diagram:
+ * lower bounds on the clocks are removed and the constraints they
+ * implied between pairs of clocks are kept.</p>
  *
  * @param cdd a CDD
- * @return the delayed CDD.
+ * @return the inverse delayed CDD.
+ * @see cdd_past(ddNode*)
  */
 cdd cdd_past(const cdd& state)
 {
     // First some trivial cases.
     if (cdd_isterminal(state.handle()))
         return state;
-    if (cdd_info(state.handle())->type == TYPE_BDD)
+    if (cdd_node_type(state.handle()) == TYPE_BDD)
         return state;
 
-    cdd copy = state;
-    cdd res = cdd_false();
-    ADBM(dbm, cdd_clocknum);
-    while (!cdd_isterminal(copy.handle()) && cdd_info(copy.handle())->type != TYPE_BDD) {
-        copy = cdd_reduce(copy);
-        cdd bottom = cdd_extract_bdd(copy, cdd_clocknum);
-        copy = cdd_extract_dbm(copy, dbm, cdd_clocknum);
-        copy = cdd_reduce(cdd_remove_negative(copy));
-        dbm_down(dbm, cdd_clocknum);
-        res |= (cdd(dbm, cdd_clocknum) & bottom);
-    }
-    free(dbm);
-    return res;
+    return cdd(cdd_past(state.handle()));
 }
+
 /**
  * Checks if a CDD is a BDD.
  * @param state: The CDD to check.
  * @return <code>true</code> if the CDD is a BDD and <code>false</code> if it is not.
  */
-bool cdd_isBDD(const cdd& state) { return cdd_isterminal(state.root) || cdd_info(state.handle())->type == TYPE_BDD; }
+bool cdd_isBDD(const cdd& state) { return cdd_isterminal(state.root) || cdd_node_type(state.handle()) == TYPE_BDD; }
 
 /**
  * Class for a 2D int32_t matrix where the number of rows is dynamic.
@@ -444,11 +693,11 @@ void cdd_bdd_to_matrix_rec(ddNode* r, dynamic_two_dim_matrix& varsMatrix, dynami
 
     // We have not reached the end of a trace.
     assert(!cdd_isterminal(r));
-    if (cdd_info(r)->type == TYPE_BDD) {
+    if (cdd_node_type(r) == TYPE_BDD) {
         bddNode* node = bdd_node(r);
 
         // First follow the true child of the BDD node.
-        varsMatrix.add_value_to_row(node->level);
+        varsMatrix.add_value_to_row(cdd_level2var[node->level]);
         valuesMatrix.add_value_to_row(1);
         cdd_bdd_to_matrix_rec(node->high, varsMatrix, valuesMatrix, current_step + 1, negated ^ cdd_is_negated(r));
 
@@ -510,48 +759,15 @@ bdd_arrays cdd_bdd_to_array(const cdd& state)
  * @param bool_values array of boolean reset values, should match the size of \a bool_resets
  * @param num_bool_resets the number of boolean variables that have to be reset,
  *      should match the size of \a bool_resets
- * @return cdd where the supplied reset has been applied
+ * @return cdd where the supplied reset has been applied; a state over
+ *      boolean variables only still gets the clock values, as its
+ *      non-negative part bounds every clock
  */
 cdd cdd_apply_reset(const cdd& state, int32_t* clock_resets, int32_t* clock_values, int32_t num_clock_resets,
                     int32_t* bool_resets, int32_t* bool_values, int32_t num_bool_resets)
 {
-    cdd copy = state;
-
-    // Apply bool resets.
-    if (num_bool_resets > 0)
-        copy = cdd_exist(copy, bool_resets, nullptr, num_bool_resets, 0);
-
-    for (int i = 0; i < num_bool_resets; i++) {
-        if (bool_values[i] == 1) {
-            copy = cdd_apply(copy, cdd_bddvarpp(bool_resets[i]), cddop_and);
-        } else {
-            copy = cdd_apply(copy, cdd_bddnvarpp(bool_resets[i]), cddop_and);
-        }
-    }
-    copy = cdd_remove_negative(copy);
-
-    // Special cases when we are already done.
-    if (num_clock_resets == 0)
-        return copy;
-    if (cdd_isterminal(copy.handle()))
-        return copy;
-    if (cdd_info(copy.handle())->type == TYPE_BDD)
-        return copy;
-
-    // Apply the clock resets.
-    cdd res = cdd_false();
-    while (!cdd_isterminal(copy.handle()) && cdd_info(copy.handle())->type != TYPE_BDD) {
-        copy = cdd_reduce(copy);
-        extraction_result exres = cdd_extract_bdd_and_dbm(copy);
-        cdd bottom = exres.BDD_part;
-        copy = cdd_reduce(cdd_remove_negative(exres.CDD_part));
-        for (int i = 0; i < num_clock_resets; i++) {
-            dbm_updateValue(exres.dbm, cdd_clocknum, clock_resets[i], clock_values[i]);
-        }
-        res |= (cdd(exres.dbm, cdd_clocknum) & bottom);
-        free(exres.dbm);
-    }
-    return res;
+    return cdd(cdd_image(state.handle(), cddtrue, clock_resets, clock_values, num_clock_resets, bool_resets,
+                         bool_values, num_bool_resets));
 }
 
 /**
@@ -572,10 +788,11 @@ cdd cdd_apply_reset(const cdd& state, int32_t* clock_resets, int32_t* clock_valu
 cdd cdd_transition(const cdd& state, const cdd& guard, int32_t* clock_resets, int32_t* clock_values,
                    int32_t num_clock_resets, int32_t* bool_resets, int32_t* bool_values, int32_t num_bool_resets)
 {
-    cdd copy = state;
-    copy &= guard;
-    return cdd_apply_reset(copy, clock_resets, clock_values, num_clock_resets, bool_resets, bool_values,
-                           num_bool_resets);
+    CDD_TRACE_BEGIN(span, state.handle(), guard.handle());
+    cdd res = cdd(cdd_image(state.handle(), guard.handle(), clock_resets, clock_values, num_clock_resets, bool_resets,
+                            bool_values, num_bool_resets));
+    CDD_TRACE_END(span, "cdd_transition", -1, res.handle());
+    return res;
 }
 
 /**
@@ -599,39 +816,12 @@ cdd cdd_transition(const cdd& state, const cdd& guard, int32_t* clock_resets, in
 cdd cdd_transition_back(const cdd& state, const cdd& guard, const cdd& update, int32_t* clock_resets,
                         int32_t num_clock_resets, int32_t* bool_resets, int32_t num_bool_resets)
 {
-    cdd copy = state;
     // TODO: sanity check: implement cdd_is_update();
     // assert(ccd_is_update(update));
-    copy &= update;
-    if (copy == cdd_false()) {
-        return copy;
-    }
-
-    // Apply bool resets.
-    if (num_bool_resets > 0)
-        copy = cdd_exist(copy, bool_resets, nullptr, num_bool_resets, 0);
-
-    // Special cases when we are already done.
-    if (num_clock_resets == 0)
-        return copy & guard;
-    if (!cdd_isterminal(copy.handle()) && cdd_info(copy.handle())->type == TYPE_BDD)
-        return copy & guard;
-
-    // Apply the clock resets.
-    cdd res = cdd_false();
-    copy = cdd_remove_negative(copy);
-    while (!cdd_isterminal(copy.handle()) && cdd_info(copy.handle())->type != TYPE_BDD) {
-        copy = cdd_reduce(copy);
-        extraction_result exres = cdd_extract_bdd_and_dbm(copy);
-        cdd bottom = exres.BDD_part;
-        copy = cdd_reduce(cdd_remove_negative(exres.CDD_part));
-        for (int i = 0; i < num_clock_resets; i++) {
-            dbm_freeClock(exres.dbm, cdd_clocknum, clock_resets[i]);
-        }
-        res |= (cdd(exres.dbm, cdd_clocknum) & bottom);
-        free(exres.dbm);
-    }
-    return res & guard;
+    // The update is conjoined with the state while the reset clocks and
+    // booleans are quantified.
+    return cdd(cdd_preimage(state.handle(), guard.handle(), update.handle(), clock_resets, num_clock_resets,
+                            bool_resets, num_bool_resets));
 }
 
 /**
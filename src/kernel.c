@@ -34,11 +34,17 @@
 #define ARCH_APPLE_DARWIN
 #endif
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CDD_X86_SIMD
+#include <immintrin.h>
+#endif
+
 #define JIT_GBC
 
-#define HASH_DENSITY  4  /**< Max. density of hash table. */
-#define THRESHOLD     5  /**< Free nodes in percent for when to GBC. */
-#define MINFREE       20 /**< Minimum free nodes in percent. */
+#define HASH_DENSITY  4   /**< Default max. density of hash table. */
+#define THRESHOLD     5   /**< Default free nodes in percent for when to GBC. */
+#define MINFREE       20  /**< Default minimum free nodes in percent. */
+#define BUCKETS       256 /**< Default initial size of a subtable. */
 #define SIZEOF_INT    4  /**< Size of integer in bytes. */
 #define SIZEOF_VOID_P 4  /**< Size of void pointer in bytes. */
 
@@ -84,6 +90,8 @@ int32_t cdd_clocknum;     /**< Number of clocks allocated. */
 int32_t cdd_varnum;       /**< Number of BDD variables allocated. */
 LevelInfo* cdd_levelinfo;
 int32_t* cdd_diff2level;
+int32_t* cdd_var2level; /**< Current level of each variable. */
+int32_t* cdd_level2var; /**< Variable at each level. */
 int32_t cdd_running;   /**< True if library has been initialised. */
 int32_t cdd_errorcond; /**< Last error code. */
 ddNode* cddfalse;      /**< True terminal. */
@@ -93,6 +101,16 @@ Elem* cdd_refstack;      /**< Base address of stack. */
 Elem* cdd_refstacktop;   /**< Top of stack. */
 size_t cdd_refstacksize; /**< Size of stack. */
 
+static cddNode* cdd_nodeimage; /**< CDD node under construction. */
+static uint32_t* cdd_nodekeys; /**< Keys of the children of a CDD node being hashed. */
+static uint32_t cdd_uidcnt;    /**< Creation number of the last node. */
+static int32_t cdd_reordering; /**< True while levels are being swapped. */
+static int32_t cdd_reorder_threshold; /**< Nodes in use that trigger reordering. */
+static int32_t cdd_reorder_holds;     /**< Sections in progress that rely on the level order. */
+static cdd_options cdd_opts;           /**< Options given to cdd_init_ex(). */
+static int32_t cdd_nodecnt;            /**< Used and dead nodes in all managers. */
+static int32_t cdd_peakcnt;            /**< Max. of cdd_nodecnt. */
+
 /*** STATIC KERNEL VARIABLES ***************************************/
 static void (*pregbc_handler)(void);               /**< Pre-gbc handler */
 static void (*postgbc_handler)(CddGbcStat*);       /**< Post-gbc handler */
@@ -120,9 +138,15 @@ static void cdd_alloc_chunk(NodeManager*);
 /** Dealloate a chunk. */
 static ddNode* cdd_alloc_node(NodeManager*);
 
+/** Allocate chunks for a number of free nodes. */
+static void cdd_prealloc_nodes(NodeManager*, int32_t);
+
 /** Rehash a subtable, doubling the size of it. */
 static void cdd_rehash(NodeManager*, SubTable*);
 
+/** Number of nodes in use of a type. */
+static int32_t cdd_used_nodes(int32_t);
+
 /**
  * @name Hash functions
  * @{
@@ -136,12 +160,15 @@ static void cdd_rehash(NodeManager*, SubTable*);
 /**
  * Hash function used to pair two DD nodes.
  */
-#define bddHash(f, g) ((uint32_t)(((uint32_t)(f) * DD_P1 + (uint32_t)(g)) * DD_P2))
+#define bddHash(f, g) ((cdd_node_key(f) * (uint32_t)DD_P1 + cdd_node_key(g)) * (uint32_t)DD_P2)
 
 /**
- * Hash function over an array of \a len Elem elements.
+ * Returns the creation number of a new node. Numbers wrap around
+ * before the key of a node overflows; see \c cdd_node_key().
  */
-#define cddHash(elem, len) (hash_computeU32((uint32_t*)(elem), (len) * (sizeof(Elem) >> 2), (len)))
+#define cdd_next_uid() (cdd_uidcnt = cdd_uidcnt % 0x7FFFFFFF + 1)
+
+static uint32_t cddHash(cddNode*);
 
 static uint32_t cdd_hash_func(NodeManager*, ddNode*);
 static uint32_t bdd_hash_func(NodeManager*, ddNode*);
@@ -154,18 +181,65 @@ int32_t cdd_error(int32_t e)
     return e;
 }
 
+void cdd_default_options(cdd_options* options, int32_t maxsize, int32_t cs, size_t stacksize)
+{
+    options->maxsize = maxsize;
+    options->stacksize = stacksize;
+    options->apply_cache = cs;
+    options->quant_cache = cs;
+    options->replace_cache = cs;
+    options->relax_cache = cs;
+    options->and_exist_cache = cs;
+    options->bdd_nodes = 0;
+    options->cdd_nodes = 0;
+    options->buckets = BUCKETS;
+    options->level_buckets = NULL;
+    options->level_count = 0;
+    options->hash_density = HASH_DENSITY;
+    options->gbc_threshold = THRESHOLD;
+    options->gbc_minfree = MINFREE;
+    options->chunk_alloc = NULL;
+    options->chunk_free = NULL;
+}
+
 int32_t cdd_init(int32_t maxsize, int32_t cs, size_t stacksize)
+{
+    cdd_options options;
+
+    cdd_default_options(&options, maxsize, cs, stacksize);
+    return cdd_init_ex(&options);
+}
+
+int32_t cdd_init_ex(const cdd_options* options)
 {
     int32_t err;
+    int32_t maxsize = options->maxsize;
+    int32_t* level_buckets = NULL;
 
     if (cdd_running) {
         return cdd_error(CDD_RUNNING);
     }
+    if (options->apply_cache <= 0 || options->quant_cache <= 0 || options->replace_cache <= 0 ||
+        options->relax_cache <= 0 || options->and_exist_cache <= 0 || options->buckets <= 0 ||
+        options->hash_density <= 0 || (options->chunk_alloc == NULL) != (options->chunk_free == NULL)) {
+        return cdd_error(CDD_RANGE);
+    }
+    if (options->level_count > 0) {
+        level_buckets = (int32_t*)malloc(options->level_count * sizeof(int32_t));
+        if (level_buckets == NULL) {
+            return cdd_error(CDD_MEMORY);
+        }
+        memcpy(level_buckets, options->level_buckets, options->level_count * sizeof(int32_t));
+    }
+    cdd_opts = *options;
+    cdd_opts.level_buckets = level_buckets;
 
     cdd_terminal.next = NULL;
     cdd_terminal.ref = MAXREF;
     cdd_terminal.level = MAXLEVEL;
     cdd_terminal.flag = 0;
+    cdd_terminal.uid = 0;
+    cdd_uidcnt = 0;
     cddfalse = &cdd_terminal;
     cddtrue = cdd_neg(cddfalse);
 
@@ -174,6 +248,8 @@ int32_t cdd_init(int32_t maxsize, int32_t cs, size_t stacksize)
     cdd_levelcnt = cdd_chunkcnt = 0;
     cdd_gbcclock = 0;
     cdd_gbccnt = 0;
+    cdd_rehashclock = 0;
+    cdd_rehashcnt = 0;
     postgbc_handler = NULL;
     pregbc_handler = NULL;
     prerehash_handler = NULL;
@@ -183,26 +259,40 @@ int32_t cdd_init(int32_t maxsize, int32_t cs, size_t stacksize)
     bddmanager = NULL;
     cdd_levelinfo = NULL;
     cdd_diff2level = NULL;
+    cdd_var2level = NULL;
+    cdd_level2var = NULL;
+    cdd_reordering = 0;
+    cdd_reorder_threshold = 0;
+    cdd_reorder_holds = 0;
+    cdd_nodecnt = 0;
+    cdd_peakcnt = 0;
     cdd_clocknum = 0;
     cdd_varnum = 0;
     cdd_postgbc_hook(cdd_default_gbhandler);
     cdd_postrehash_hook(cdd_default_rehashhandler);
 
-    if ((err = cdd_operator_init(cs)) < 0) {
+    if ((err = cdd_operator_init(options)) < 0) {
         cdd_done();
         return err;
     }
 
-    cdd_refstacksize = stacksize;
-    cdd_refstack = cdd_refstacktop = (Elem*)malloc(sizeof(Elem) * stacksize);
+    cdd_refstacksize = options->stacksize;
+    cdd_refstack = cdd_refstacktop = (Elem*)malloc(sizeof(Elem) * options->stacksize);
+    cdd_nodeimage = (cddNode*)malloc(cdd_bnd_offset + cdd_elem_size(maxsize + 1));
+    cdd_nodekeys = (uint32_t*)malloc((maxsize + 1) * sizeof(uint32_t));
     cddmanager = (NodeManager**)calloc(maxsize + 1, sizeof(NodeManager*));
     bddmanager = cdd_alloc_nodemanager(sizeof(bddNode), bdd_hash_func);
 
-    if (cdd_refstack == NULL || cddmanager == NULL || bddmanager == NULL) {
+    if (cdd_refstack == NULL || cdd_nodeimage == NULL || cdd_nodekeys == NULL || cddmanager == NULL ||
+        bddmanager == NULL) {
         cdd_done();
         return cdd_error(CDD_MEMORY);
     }
 
+    // The sentinel ends the BDD hash chains, so it must order below any node
+    bdd_node(bddmanager->sentinel)->low = bdd_node(bddmanager->sentinel)->high = cddfalse;
+    cdd_prealloc_nodes(bddmanager, options->bdd_nodes);
+
     cdd_running = 1;
 
     return 0;
@@ -238,6 +328,7 @@ void cdd_add_tautologies(int32_t n)
         node->ref = MAXREF;
         node->level = MAXLEVEL;
         node->flag = 0;
+        node->uid = cdd_next_uid();
         node->id = i;
         extra_terminals[i] = (ddNode*)node;
     }
@@ -249,9 +340,9 @@ ddNode* cdd_apply_tautology(ddNode* node, int32_t t_id)
     return cdd_apply(node, extra_terminals[t_id], cddop_and);
 }
 
-int32_t cdd_isterminal(ddNode* node) { return cdd_rglr(node)->level == MAXLEVEL; }
+int32_t(cdd_isterminal)(ddNode* node) { return cdd_isterminal(node); }
 
-int32_t cdd_is_extra_terminal(ddNode* node) { return cdd_rglr(node) != cddfalse && cdd_isterminal(node); }
+int32_t(cdd_is_extra_terminal)(ddNode* node) { return cdd_is_extra_terminal(node); }
 
 int32_t cdd_get_tautology_id(ddNode* node)
 {
@@ -278,14 +369,25 @@ void cdd_done()
     }
 
     cdd_operator_done();
+#ifdef CDD_TRACE
+    cdd_trace_done();
+#endif
     cdd_dealloc_nodemanager(bddmanager);
     for (i = 0; i <= cdd_maxcddsize; i++) {
         cdd_dealloc_nodemanager(cddmanager[i]);
     }
     free(cddmanager);
     free(cdd_refstack);
+    free(cdd_nodeimage);
+    cdd_nodeimage = NULL;
+    free(cdd_nodekeys);
+    cdd_nodekeys = NULL;
     free(cdd_levelinfo);
     free(cdd_diff2level);
+    free(cdd_var2level);
+    free(cdd_level2var);
+    free((int32_t*)cdd_opts.level_buckets);
+    cdd_opts.level_buckets = NULL;
 #ifdef MULTI_TERMINAL
     for (i = 0; i < nb_extra_terminals; ++i) {
         free(extra_terminals[i]);
@@ -299,6 +401,9 @@ void cdd_done()
 
 static Chunk* cdd_allocate_chunk_from_os()
 {
+    if (cdd_opts.chunk_alloc) {
+        return (Chunk*)cdd_opts.chunk_alloc(CHUNKSIZE);
+    }
 #if defined(WIN32)
     return (Chunk*)VirtualAlloc(0, CHUNKSIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 #elif defined(ARCH_APPLE_DARWIN)
@@ -312,6 +417,10 @@ static Chunk* cdd_allocate_chunk_from_os()
 
 static void cdd_deallocate_chunk_to_os(Chunk* chunk)
 {
+    if (cdd_opts.chunk_free) {
+        cdd_opts.chunk_free(chunk);
+        return;
+    }
 #if defined(WIN32)
     VirtualFree(chunk, CHUNKSIZE, MEM_DECOMMIT | MEM_RELEASE);
 #elif defined(ARCH_APPLE_DARWIN)
@@ -323,14 +432,25 @@ static void cdd_deallocate_chunk_to_os(Chunk* chunk)
 
 static SubTable* cdd_alloc_subtable(NodeManager* man, int32_t level)
 {
-    int32_t i;
+    int32_t i, buckets;
     SubTable* tbl = (SubTable*)malloc(sizeof(SubTable));
+
+    buckets = cdd_opts.buckets;
+    if (level < cdd_opts.level_count && cdd_opts.level_buckets[level] > 0) {
+        buckets = cdd_opts.level_buckets[level];
+    }
     tbl->level = level;
     tbl->deadcnt = 0;
-    tbl->shift = SIZEOF_INT * 8 - 8;
-    tbl->buckets = 256;
+    tbl->shift = SIZEOF_INT * 8 - 1;
+    tbl->buckets = 2;
+    while (tbl->buckets < buckets && tbl->shift > 1) {
+        tbl->buckets <<= 1;
+        tbl->shift--;
+    }
     tbl->keys = 0;
-    tbl->maxkeys = tbl->buckets * HASH_DENSITY;
+    tbl->maxkeys = tbl->buckets * cdd_opts.hash_density;
+    tbl->lookups = 0;
+    tbl->inserts = 0;
     tbl->hash = (ddNode**)malloc(tbl->buckets * sizeof(ddNode*));
     for (i = 0; i < tbl->buckets; i++) {
         tbl->hash[i] = man->sentinel;
@@ -360,11 +480,18 @@ static NodeManager* cdd_alloc_nodemanager(int32_t size, NodeHashFunc hashfunc)
     man->deadcnt = 0;
     man->gbccnt = 0;
     man->gbcclock = 0;
+    man->peakcnt = 0;
+    man->reclaimcnt = 0;
     man->free = NULL;
     man->nodes = NULL;
     man->hashfunc = hashfunc;
     man->subtables = calloc(cdd_levelcnt, sizeof(SubTable*));
-    man->sentinel = cdd_alloc_node(man);
+
+    // The sentinel is not counted as a used node
+    cdd_alloc_chunk(man);
+    man->sentinel = man->free;
+    man->free = man->free->next;
+    man->freecnt--;
     memset(man->sentinel, 0, size);
 
     return man;
@@ -422,9 +549,80 @@ static void cdd_alloc_chunk(NodeManager* man)
     cdd_chunkcnt++;
 }
 
+/* Allocates chunks until \a man has \a n free nodes. */
+static void cdd_prealloc_nodes(NodeManager* man, int32_t n)
+{
+    while (man->freecnt < n) {
+        cdd_alloc_chunk(man);
+    }
+}
+
+/* Hashes the bounds of a CDD node together with the keys of its
+ * children. */
+static uint32_t cddHash(cddNode* node)
+{
+    int32_t i, len = node->len;
+    ddNode** children = cdd_node_child(node);
+
+    for (i = 0; i < len; i++) {
+        cdd_nodekeys[i] = cdd_node_key(children[i]);
+    }
+    return hash_computeU32(cdd_nodekeys, len, hash_computeU32((const uint32_t*)node->bnd, len, len));
+}
+
+/* Orders the node image against \a node, which has the same number of
+ * elements. Hash chains are kept in descending order. The bounds are
+ * compared bytewise, so the zeroed sentinel is below any node, and the
+ * children by their keys. Distinct children with equal keys (after the
+ * creation numbers wrapped) order the image below, so lookups go on to
+ * the rest of the chain.
+ */
+static int32_t cdd_image_cmp(cddNode* node)
+{
+    int32_t i, len = cdd_nodeimage->len;
+    ddNode **a, **b;
+    uint32_t x, y;
+
+    if ((i = memcmp(cdd_nodeimage->bnd, node->bnd, len * sizeof(raw_t))) != 0) {
+        return i;
+    }
+    a = cdd_node_child(cdd_nodeimage);
+    b = cdd_node_child(node);
+    if (memcmp(a, b, len * sizeof(ddNode*)) == 0) {
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        x = cdd_node_key(a[i]);
+        y = cdd_node_key(b[i]);
+        if (x != y) {
+            return x < y ? -1 : 1;
+        }
+    }
+    return -1;
+}
+
+/* Orders the BDD node (low, high) against \a node, as done for CDD
+ * nodes by \c cdd_image_cmp(). The sentinel has false children and is
+ * below any node. */
+static int32_t bdd_cmp(ddNode* low, ddNode* high, bddNode* node)
+{
+    uint32_t x, y;
+
+    if (low == node->low && high == node->high) {
+        return 0;
+    }
+    x = cdd_node_key(low);
+    y = cdd_node_key(node->low);
+    if (x == y) {
+        x = cdd_node_key(high);
+        y = cdd_node_key(node->high);
+    }
+    return x > y ? 1 : -1;
+}
+
 static uint32_t cdd_hash_func(NodeManager* man, ddNode* node)
 {
-    return cddHash(cdd_node(node)->elem, (man->nodesize - sizeof(cddNode)) / sizeof(Elem));
+    return cddHash(cdd_node(node));
 }
 
 static uint32_t bdd_hash_func(NodeManager* man, ddNode* node)
@@ -449,7 +647,7 @@ void cdd_rec_deref(ddNode* node)
             cdd_node2chunk(node)->man->usedcnt--;
             cdd_node2chunk(node)->man->deadcnt++;
             cdd_node2chunk(node)->man->subtables[node->level]->deadcnt++;
-            switch (cdd_info(node)->type) {
+            switch (cdd_node_type(node)) {
             case TYPE_BDD:
                 *(top++) = bdd_node(node)->low;
                 *(top++) = bdd_node(node)->high;
@@ -473,10 +671,11 @@ void cdd_reclaim(ddNode* node)
 
     do {
         node = cdd_rglr(*(--top));
+        cdd_node2chunk(node)->man->reclaimcnt++;
         cdd_node2chunk(node)->man->usedcnt++;
         cdd_node2chunk(node)->man->deadcnt--;
         cdd_node2chunk(node)->man->subtables[node->level]->deadcnt--;
-        switch (cdd_info(node)->type) {
+        switch (cdd_node_type(node)) {
         case TYPE_CDD:
             cdd_it_init(it, node);
             while (!cdd_it_atend(it)) {
@@ -499,18 +698,14 @@ void cdd_reclaim(ddNode* node)
     } while (top > (ddNode**)cdd_refstacktop);
 }
 
-static void cdd_gbc_nodemanager(NodeManager* man)
+/* Moves the dead nodes of \a man to the free list. */
+static void cdd_sweep_nodemanager(NodeManager* man)
 {
     SubTable* tbl;
     ddNode *node, *next, **p;
-    int64_t clk = clock();
     int32_t i;
     int32_t j;
 
-    if (pregbc_handler != NULL) {
-        pregbc_handler();
-    }
-
     for (i = 0; i < cdd_levelcnt; i++) {
         tbl = man->subtables[i];
         if (tbl == NULL || tbl->deadcnt == 0) {
@@ -536,10 +731,26 @@ static void cdd_gbc_nodemanager(NodeManager* man)
         tbl->deadcnt = 0;
     }
 
-    clk = clock() - clk;
-
     man->freecnt += man->deadcnt;
+    cdd_nodecnt -= man->deadcnt;
     man->deadcnt = 0;
+}
+
+static void cdd_gbc_nodemanager(NodeManager* man)
+{
+    int64_t clk = clock();
+    CDD_TRACE_CLOCK(start);
+    CDD_TRACE_COUNT(freed, man->deadcnt);
+
+    if (pregbc_handler != NULL) {
+        pregbc_handler();
+    }
+
+    cdd_sweep_nodemanager(man);
+
+    clk = clock() - clk;
+    CDD_TRACE_GBC(start, man->nodesize, freed, man->usedcnt);
+
     man->gbccnt++;
     man->gbcclock += clk;
 
@@ -557,7 +768,8 @@ static void cdd_gbc_nodemanager(NodeManager* man)
     }
 }
 
-void cdd_gbc()
+/* Garbage collects the node managers that are short of free nodes. */
+static void cdd_gbc_managers()
 {
     int32_t i;
     int64_t clk = clock();
@@ -567,32 +779,68 @@ void cdd_gbc()
     cdd_gbcclock += clock() - clk;
 
     // Check BDD manager
-    if (THRESHOLD * bddmanager->alloccnt >= 100 * bddmanager->freecnt &&
-        MINFREE * bddmanager->alloccnt < 100 * bddmanager->deadcnt) {
+    if (cdd_opts.gbc_threshold * bddmanager->alloccnt >= 100 * bddmanager->freecnt &&
+        cdd_opts.gbc_minfree * bddmanager->alloccnt < 100 * bddmanager->deadcnt) {
         cdd_gbc_nodemanager(bddmanager);
     }
 
     // Check CDD managers
     for (i = 2; i <= cdd_maxcddused; i++) {
-        if (cddmanager[i] && THRESHOLD * cddmanager[i]->alloccnt >= 100 * cddmanager[i]->freecnt &&
-            MINFREE * cddmanager[i]->alloccnt < 100 * cddmanager[i]->deadcnt) {
+        if (cddmanager[i] && cdd_opts.gbc_threshold * cddmanager[i]->alloccnt >= 100 * cddmanager[i]->freecnt &&
+            cdd_opts.gbc_minfree * cddmanager[i]->alloccnt < 100 * cddmanager[i]->deadcnt) {
             cdd_gbc_nodemanager(cddmanager[i]);
         }
     }
 }
 
+/* Reorders when the diagrams have grown past the threshold, unless a
+ * section that relies on the level order is in progress. */
+static void cdd_autoreorder_check()
+{
+    int32_t used;
+
+    if (cdd_reorder_holds > 0 || cdd_used_nodes(TYPE_BDD) + cdd_used_nodes(TYPE_CDD) <= cdd_reorder_threshold) {
+        return;
+    }
+    used = cdd_reorder();
+    if (cdd_reorder_threshold < 2 * used) {
+        cdd_reorder_threshold = 2 * used;
+    }
+}
+
+void cdd_gbc()
+{
+    cdd_gbc_managers();
+    if (cdd_reorder_threshold > 0) {
+        cdd_autoreorder_check();
+    }
+}
+
+void cdd_reorder_point()
+{
+    // The node count includes the dead nodes, so it is checked first
+    if (cdd_reorder_threshold > 0 && cdd_nodecnt > cdd_reorder_threshold && cdd_refstacktop == cdd_refstack) {
+        cdd_autoreorder_check();
+    }
+}
+
+void cdd_reorder_hold() { cdd_reorder_holds++; }
+
+void cdd_reorder_release() { cdd_reorder_holds--; }
+
 static ddNode* cdd_alloc_node(NodeManager* man)
 {
     ddNode* node;
 
     // Free nodes left?
     if (man->free == NULL) {
-        if (MINFREE * man->alloccnt < 100 * man->deadcnt) {
+        // Levels are inconsistent while being swapped, so no GBC then
+        if (!cdd_reordering && cdd_opts.gbc_minfree * man->alloccnt < 100 * man->deadcnt) {
 #ifdef JIT_GBC
             cdd_operator_flush();
             cdd_gbc_nodemanager(man);
 #else
-            cdd_gbc();
+            cdd_gbc_managers();
 #endif
         } else {
             cdd_alloc_chunk(man);
@@ -606,6 +854,12 @@ static ddNode* cdd_alloc_node(NodeManager* man)
     // Update counters
     man->usedcnt++;
     man->freecnt--;
+    if (man->usedcnt + man->deadcnt > man->peakcnt) {
+        man->peakcnt = man->usedcnt + man->deadcnt;
+    }
+    if (++cdd_nodecnt > cdd_peakcnt) {
+        cdd_peakcnt = cdd_nodecnt;
+    }
 
     return node;
 }
@@ -614,7 +868,7 @@ ddNode* cdd_make_bdd_node(int32_t level, ddNode* low, ddNode* high)
 {
     bddNode* node;
     bddNode** p;
-    int32_t bucket, cnt, mask;
+    int32_t bucket, cnt, mask, i;
     SubTable* tbl;
 
     // Eliminate redundant nodes
@@ -634,15 +888,13 @@ ddNode* cdd_make_bdd_node(int32_t level, ddNode* low, ddNode* high)
     }
 
     // Look for existing node
+    tbl->lookups++;
     bucket = bddHash(low, high) >> tbl->shift;
     p = (bddNode**)&(tbl->hash[bucket]);
-    while (low < (*p)->low) {
-        p = (bddNode**)&((*p)->next);
-    }
-    while (low == (*p)->low && high < (*p)->high) {
+    while ((i = bdd_cmp(low, high, *p)) < 0) {
         p = (bddNode**)&((*p)->next);
     }
-    if (low == (*p)->low && high == (*p)->high) {
+    if (i == 0) {
         if ((*p)->ref == 0) {
             cdd_reclaim((ddNode*)*p);
         }
@@ -660,21 +912,22 @@ ddNode* cdd_make_bdd_node(int32_t level, ddNode* low, ddNode* high)
     // If garbage collection has occured we need to recalc node pos
     if (cnt != cdd_gbccnt) {
         p = (bddNode**)&(tbl->hash[bucket]);
-        while (low < (*p)->low) {
-            p = (bddNode**)&((*p)->next);
-        }
-        while (low == (*p)->low && high < (*p)->high) {
+        while (bdd_cmp(low, high, *p) < 0) {
             p = (bddNode**)&((*p)->next);
         }
     }
 
     // Add node to hash chain
+    tbl->inserts++;
     node->next = (ddNode*)*p;
     *p = node;
 
     // Initialise node
     node->ref = 0;
+    node->flag = 0;
     node->level = level;
+    node->type = TYPE_BDD;
+    node->uid = cdd_next_uid();
     node->low = low;
     node->high = high;
 
@@ -687,13 +940,31 @@ ddNode* cdd_make_bdd_node(int32_t level, ddNode* low, ddNode* high)
     return cdd_neg_cond((ddNode*)node, mask);
 }
 
+/* Returns the node manager of CDD nodes with \a len elements,
+ * allocating it the first time. */
+static NodeManager* cdd_arity_manager(int32_t len)
+{
+    NodeManager* man = cddmanager[len];
+
+    if (man == NULL) {
+        man = cddmanager[len] = cdd_alloc_nodemanager(cdd_bnd_offset + cdd_elem_size(len), cdd_hash_func);
+        cdd_prealloc_nodes(man, cdd_opts.cdd_nodes);
+        if (len > cdd_maxcddused) {
+            cdd_maxcddused = len;
+        }
+    }
+    return man;
+}
+
 ddNode* cdd_make_cdd_node(int32_t level, Elem* elem, int32_t len)
 {
     SubTable* tbl;
     NodeManager* man;
-    int32_t bucket, i, size;
+    int32_t bucket, i;
     cddNode* node;
     cddNode** p;
+    ddNode** children;
+    size_t bytes;
 
     if (len > cdd_maxcddsize) {
         cdd_error(CDD_MAXSIZE);
@@ -705,24 +976,27 @@ ddNode* cdd_make_cdd_node(int32_t level, Elem* elem, int32_t len)
         return elem[0].child;
     }
 
-    // Find manager and subtable
-    man = cddmanager[len];
-    if (man == NULL) {
-        size = sizeof(cddNode) + sizeof(Elem) * len;
-        man = cddmanager[len] = cdd_alloc_nodemanager(size, cdd_hash_func);
-        if (len > cdd_maxcddused) {
-            cdd_maxcddused = len;
-        }
+    // Lay the elements out as in the node
+    bytes = cdd_elem_size(len);
+    cdd_nodeimage->len = len;
+    children = cdd_node_child(cdd_nodeimage);
+    for (i = 0; i < len; i++) {
+        cdd_nodeimage->bnd[i] = elem[i].bnd;
+        children[i] = elem[i].child;
     }
+
+    // Find manager and subtable
+    man = cdd_arity_manager(len);
     tbl = man->subtables[level];
     if (tbl == NULL) {
         tbl = cdd_alloc_subtable(man, level);
     }
 
     // Look for existing node
-    bucket = cddHash(elem, len) >> tbl->shift;
+    tbl->lookups++;
+    bucket = cddHash(cdd_nodeimage) >> tbl->shift;
     p = (cddNode**)&(tbl->hash[bucket]);
-    while ((i = memcmp(elem, (*p)->elem, len * sizeof(Elem))) < 0) {
+    while ((i = cdd_image_cmp(*p)) < 0) {
         p = (cddNode**)&((*p)->next);
     }
     if (i == 0) {
@@ -734,7 +1008,7 @@ ddNode* cdd_make_cdd_node(int32_t level, Elem* elem, int32_t len)
 
     // Increment references
     for (i = 0; i < len; i++) {
-        cdd_ref(elem[i].child);
+        cdd_ref(children[i]);
     }
 
     // Alloc node
@@ -744,19 +1018,24 @@ ddNode* cdd_make_cdd_node(int32_t level, Elem* elem, int32_t len)
     // If garbage collection has occured we need to recalc the node pos
     if (i != cdd_gbccnt) {
         p = (cddNode**)&(tbl->hash[bucket]);
-        while (memcmp(elem, (*p)->elem, len * sizeof(Elem)) < 0) {
+        while (cdd_image_cmp(*p) < 0) {
             p = (cddNode**)&((*p)->next);
         }
     }
 
     // Add node to hash chain
+    tbl->inserts++;
     node->next = (ddNode*)*p;
     *p = node;
 
     // Initialise node
     node->level = level;
+    node->type = TYPE_CDD;
+    node->uid = cdd_next_uid();
     node->ref = 0;
-    memcpy(node->elem, elem, sizeof(Elem) * len);
+    node->flag = 0;
+    node->len = len;
+    memcpy(node->bnd, cdd_nodeimage->bnd, bytes);
 
     // Check whether max keys has been reached
     tbl->keys++;
@@ -804,6 +1083,11 @@ static void cdd_rehash(NodeManager* man, SubTable* tbl)
     int32_t oldsize;
     ddNode **p, **q, *node, **oldhash;
     int64_t clk = clock();
+    CDD_TRACE_CLOCK(start);
+
+    if (prerehash_handler != NULL) {
+        prerehash_handler();
+    }
 
     oldsize = tbl->buckets;
     oldhash = tbl->hash;
@@ -831,10 +1115,11 @@ static void cdd_rehash(NodeManager* man, SubTable* tbl)
     free(oldhash);
 
     clk = clock() - clk;
+    CDD_TRACE_REHASH(start, tbl->level, tbl->buckets, tbl->keys);
     cdd_rehashclock += clk;
     cdd_rehashcnt++;
 
-    if (postgbc_handler != NULL) {
+    if (postrehash_handler != NULL) {
         CddRehashStat s;
         s.level = tbl->level;
         s.buckets = tbl->buckets;
@@ -847,7 +1132,7 @@ static void cdd_rehash(NodeManager* man, SubTable* tbl)
     }
 }
 
-ddNode* cdd_bddvar(int32_t level) { return cdd_make_bdd_node(level, cddfalse, cddtrue); }
+ddNode* cdd_bddvar(int32_t level) { return cdd_make_bdd_node(cdd_var2level[level], cddfalse, cddtrue); }
 
 ddNode* cdd_interval_from_level(int32_t level, raw_t low, raw_t high)
 {
@@ -881,6 +1166,182 @@ ddNode* cdd_upper_from_level(int32_t level, raw_t bnd)
     return cdd_neg(cdd_make_cdd_node(level, top, 2));
 }
 
+/* Number of bounds left for a linear scan by cdd_bnd_seek() */
+#define SEEK_SCAN 32
+
+static int32_t cdd_bnd_scan_scalar(const raw_t* bnd, int32_t from, raw_t target)
+{
+    while (bnd[from] < target) {
+        from++;
+    }
+    return from;
+}
+
+#ifdef CDD_X86_SIMD
+__attribute__((target("avx2"))) static int32_t cdd_bnd_scan_avx2(const raw_t* bnd, int32_t from, int32_t last,
+                                                                 raw_t target)
+{
+    __m256i t = _mm256_set1_epi32(target);
+    uint32_t below;
+
+    for (; from + 8 <= last + 1; from += 8) {
+        below = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(t, _mm256_loadu_si256((const __m256i*)(bnd + from)))));
+        if (below != 0xFF) {
+            return from + __builtin_ctz(~below);
+        }
+    }
+    return cdd_bnd_scan_scalar(bnd, from, target);
+}
+
+__attribute__((target("sse2"))) static int32_t cdd_bnd_scan_sse2(const raw_t* bnd, int32_t from, int32_t last,
+                                                                 raw_t target)
+{
+    __m128i t = _mm_set1_epi32(target);
+    uint32_t below;
+
+    for (; from + 4 <= last + 1; from += 4) {
+        below = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(t, _mm_loadu_si128((const __m128i*)(bnd + from)))));
+        if (below != 0xF) {
+            return from + __builtin_ctz(~below);
+        }
+    }
+    return cdd_bnd_scan_scalar(bnd, from, target);
+}
+#endif
+
+/* Finds the first index from \a from to \a last with a bound of at
+ * least \a target, scanning the bounds in order.
+ */
+static int32_t cdd_bnd_scan(const raw_t* bnd, int32_t from, int32_t last, raw_t target)
+{
+#ifdef CDD_X86_SIMD
+    static int32_t avx2 = -1;
+    if (avx2 < 0) {
+        avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    if (avx2) {
+        return cdd_bnd_scan_avx2(bnd, from, last, target);
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return cdd_bnd_scan_sse2(bnd, from, last, target);
+    }
+#endif
+    (void)last;
+    return cdd_bnd_scan_scalar(bnd, from, target);
+}
+
+int32_t cdd_bnd_seek(const raw_t* bnd, int32_t from, int32_t last, raw_t target)
+{
+    int32_t hi, mid, step;
+
+    if (last - from <= SEEK_SCAN) {
+        return cdd_bnd_scan(bnd, from, last, target);
+    }
+    if (bnd[from] >= target) {
+        return from;
+    }
+
+    // Gallop until the bound is passed, keeping bnd[from] < target
+    for (step = 1;; step <<= 1) {
+        hi = (last - from > step) ? from + step : last;
+        if (bnd[hi] >= target) {
+            break;
+        }
+        from = hi;
+    }
+
+    // Binary search in (from, hi] down to a short scan
+    while (hi - from > SEEK_SCAN) {
+        mid = from + (hi - from) / 2;
+        if (bnd[mid] >= target) {
+            hi = mid;
+        } else {
+            from = mid;
+        }
+    }
+    return cdd_bnd_scan(bnd, from + 1, hi, target);
+}
+
+/* Counts for each of the \a n targets the bounds before \a last that
+ * are below it, which for sorted bounds is the first index with a bound
+ * of at least the target.
+ */
+static void cdd_bnd_rank_scalar(const raw_t* bnd, int32_t last, const raw_t* targets, int32_t* idx, size_t n)
+{
+    size_t k;
+
+    for (k = 0; k < n; k++) {
+        idx[k] = cdd_bnd_scan_scalar(bnd, 0, targets[k]);
+    }
+    (void)last;
+}
+
+#ifdef CDD_X86_SIMD
+__attribute__((target("avx2"))) static void cdd_bnd_rank_avx2(const raw_t* bnd, int32_t last, const raw_t* targets,
+                                                               int32_t* idx, size_t n)
+{
+    __m256i t, below;
+    int32_t b;
+    size_t k;
+
+    for (k = 0; k + 8 <= n; k += 8) {
+        t = _mm256_loadu_si256((const __m256i*)(targets + k));
+        below = _mm256_setzero_si256();
+        for (b = 0; b < last; b++) {
+            below = _mm256_sub_epi32(below, _mm256_cmpgt_epi32(t, _mm256_set1_epi32(bnd[b])));
+        }
+        _mm256_storeu_si256((__m256i*)(idx + k), below);
+    }
+    cdd_bnd_rank_scalar(bnd, last, targets + k, idx + k, n - k);
+}
+
+__attribute__((target("sse2"))) static void cdd_bnd_rank_sse2(const raw_t* bnd, int32_t last, const raw_t* targets,
+                                                              int32_t* idx, size_t n)
+{
+    __m128i t, below;
+    int32_t b;
+    size_t k;
+
+    for (k = 0; k + 4 <= n; k += 4) {
+        t = _mm_loadu_si128((const __m128i*)(targets + k));
+        below = _mm_setzero_si128();
+        for (b = 0; b < last; b++) {
+            below = _mm_sub_epi32(below, _mm_cmpgt_epi32(t, _mm_set1_epi32(bnd[b])));
+        }
+        _mm_storeu_si128((__m128i*)(idx + k), below);
+    }
+    cdd_bnd_rank_scalar(bnd, last, targets + k, idx + k, n - k);
+}
+#endif
+
+void cdd_bnd_seek_n(const raw_t* bnd, int32_t last, const raw_t* targets, int32_t* idx, size_t n)
+{
+    size_t k;
+
+    if (last > SEEK_SCAN) {
+        for (k = 0; k < n; k++) {
+            idx[k] = cdd_bnd_seek(bnd, 0, last, targets[k]);
+        }
+        return;
+    }
+#ifdef CDD_X86_SIMD
+    static int32_t avx2 = -1;
+    if (avx2 < 0) {
+        avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    if (avx2) {
+        cdd_bnd_rank_avx2(bnd, last, targets, idx, n);
+        return;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        cdd_bnd_rank_sse2(bnd, last, targets, idx, n);
+        return;
+    }
+#endif
+    cdd_bnd_rank_scalar(bnd, last, targets, idx, n);
+}
+
 ddNode* cdd_interval(int32_t i, int32_t j, raw_t low, raw_t high)
 {
     return (i > j) ? cdd_interval_from_level(cdd_diff2level[cdd_difference(i, j)], low, high)
@@ -905,7 +1366,7 @@ void cdd_mark(ddNode* node)
     }
 
     cdd_setmark(node);
-    switch (cdd_info(node)->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it))
             cdd_mark(cdd_it_child(it));
@@ -924,7 +1385,7 @@ void cdd_markcount(ddNode* node, int32_t* cnt)
 
     (*cnt)++;
     cdd_setmark(node);
-    switch (cdd_info(node)->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it))
             cdd_markcount(cdd_it_child(it), cnt);
@@ -942,7 +1403,7 @@ void cdd_markedgecount(ddNode* node, int32_t* cnt)
     }
 
     cdd_setmark(node);
-    switch (cdd_info(node)->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it)) {
             (*cnt)++;
@@ -971,7 +1432,7 @@ void cdd_unmark(ddNode* node)
         return;
 #endif
 
-    switch (cdd_info(node)->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it))
             cdd_unmark(cdd_it_child(it));
@@ -997,7 +1458,7 @@ void cdd_force_unmark(ddNode* node)
         return;
 #endif
 
-    switch (cdd_info(node)->type) {
+    switch (cdd_node_type(node)) {
     case TYPE_CDD:
         for (cdd_it_init(it, node); !cdd_it_atend(it); cdd_it_next(it))
             cdd_force_unmark(cdd_it_child(it));
@@ -1035,12 +1496,27 @@ static void add_levels(int32_t n)
             add_levels_to_nodemanager(cddmanager[i], n);
         }
     }
+
+    // New variables are placed at the level they are added at
+    cdd_var2level = realloc(cdd_var2level, (cdd_levelcnt + n) * sizeof(int32_t));
+    cdd_level2var = realloc(cdd_level2var, (cdd_levelcnt + n) * sizeof(int32_t));
+    for (i = cdd_levelcnt; i < cdd_levelcnt + n; i++) {
+        cdd_var2level[i] = cdd_level2var[i] = i;
+    }
 }
 
-void cdd_add_clocks(int32_t n)
+/**
+ * Adds \a n clocks. The clocks are taken in the order given by \a
+ * order, which lists all clocks with the ones already declared first,
+ * and each new clock gets the levels of its differences to the clocks
+ * before it. The differences to the clocks in \a deps come first.
+ * @param n the number of clocks to add
+ * @param order a permutation of the clocks
+ * @param deps flags of size cdd_clocknum + n, or NULL
+ */
+static void add_clock_levels(int32_t n, const int32_t* order, const char* deps)
 {
-    int32_t i;
-    int32_t j;
+    int32_t p, q, i, j, pass;
     int32_t diffs;  // Number of new levels
     LevelInfo* info;
 
@@ -1050,20 +1526,99 @@ void cdd_add_clocks(int32_t n)
     cdd_levelinfo = realloc(cdd_levelinfo, (cdd_levelcnt + diffs) * sizeof(LevelInfo));
 
     info = cdd_levelinfo + cdd_levelcnt;
-    for (i = cdd_clocknum; i < cdd_clocknum + n; i++) {
-        for (j = 0; j < i; j++) {
-            info->type = TYPE_CDD;
-            info->clock1 = i;
-            info->clock2 = j;
-            info->diff = cdd_difference(i, j);
-            cdd_diff2level[info->diff] = cdd_levelcnt;
-            info++;
-            cdd_levelcnt++;
+    for (p = cdd_clocknum; p < cdd_clocknum + n; p++) {
+        for (pass = deps ? 0 : 1; pass < 2; pass++) {
+            for (q = 0; q < p; q++) {
+                if (deps && deps[(cdd_clocknum + n) * order[p] + order[q]] == pass) {
+                    continue;
+                }
+                i = order[p] > order[q] ? order[p] : order[q];
+                j = order[p] + order[q] - i;
+                info->type = TYPE_CDD;
+                info->clock1 = i;
+                info->clock2 = j;
+                info->diff = cdd_difference(i, j);
+                cdd_diff2level[info->diff] = cdd_levelcnt;
+                info++;
+                cdd_levelcnt++;
+            }
         }
     }
     cdd_clocknum += n;
 }
 
+void cdd_add_clocks(int32_t n)
+{
+    int32_t i;
+
+    if (n <= 0) {
+        return;
+    }
+    int32_t order[cdd_clocknum + n];
+    for (i = 0; i < cdd_clocknum + n; i++) {
+        order[i] = i;
+    }
+    add_clock_levels(n, order, NULL);
+}
+
+void cdd_add_clocks_ordered(int32_t n, const int32_t* deps, int32_t ndeps)
+{
+    int32_t num = cdd_clocknum + n;
+    int32_t i, k, p, best, bestcnt, cnt;
+    char* dep;
+
+    if (n <= 0) {
+        return;
+    }
+    int32_t order[num];
+    char placed[num];
+    dep = (char*)calloc((size_t)num * num, 1);
+    if (dep == NULL) {
+        cdd_error(CDD_MEMORY);
+        return;
+    }
+    for (k = 0; k < ndeps; k++) {
+        assert(0 <= deps[2 * k] && deps[2 * k] < num && 0 <= deps[2 * k + 1] && deps[2 * k + 1] < num);
+        dep[num * deps[2 * k] + deps[2 * k + 1]] = 1;
+        dep[num * deps[2 * k + 1] + deps[2 * k]] = 1;
+    }
+
+    // The declared clocks keep their order, and the reference clock
+    // goes first
+    memset(placed, 0, num);
+    for (p = 0; p < cdd_clocknum; p++) {
+        order[p] = p;
+        placed[p] = 1;
+    }
+    if (p == 0 && num > 0) {
+        order[p++] = 0;
+        placed[0] = 1;
+    }
+
+    // Then repeatedly the clock depending on most of the placed ones
+    for (; p < num; p++) {
+        best = -1;
+        bestcnt = -1;
+        for (i = 0; i < num; i++) {
+            if (placed[i]) {
+                continue;
+            }
+            for (cnt = k = 0; k < p; k++) {
+                cnt += dep[num * i + order[k]];
+            }
+            if (cnt > bestcnt) {
+                best = i;
+                bestcnt = cnt;
+            }
+        }
+        order[p] = best;
+        placed[best] = 1;
+    }
+
+    add_clock_levels(n, order, dep);
+    free(dep);
+}
+
 int32_t cdd_getclocks() { return cdd_clocknum; }
 
 int32_t cdd_add_bddvar(int32_t n)
@@ -1095,6 +1650,793 @@ int32_t cdd_get_level_count() { return cdd_levelcnt; }
 
 int32_t cdd_get_bdd_level_count() { return cdd_varnum; }
 
+/*** STATISTICS *****************************************************/
+
+/* Fills in the counters of a node manager. */
+static int32_t cdd_manager_stats_get(cdd_manager_stats* s, NodeManager* man, int32_t type, int32_t arity)
+{
+    SubTable* tbl;
+    cdd_level_stats* l;
+    ddNode* node;
+    int32_t i, j, chains, keys;
+
+    s->type = type;
+    s->arity = arity;
+    s->alive = man->usedcnt;
+    s->dead = man->deadcnt;
+    s->free = man->freecnt;
+    s->peak = man->peakcnt;
+    s->chunkbytes = (int64_t)man->chunkcnt * CHUNKSIZE;
+    s->reclaims = man->reclaimcnt;
+    s->gbcnum = man->gbccnt;
+    s->levelnum = 0;
+    s->levels = NULL;
+    for (i = 0; i < cdd_levelcnt; i++) {
+        s->levelnum += man->subtables[i] != NULL;
+    }
+    if (s->levelnum == 0) {
+        return 0;
+    }
+    s->levels = (cdd_level_stats*)malloc(s->levelnum * sizeof(cdd_level_stats));
+    if (s->levels == NULL) {
+        return cdd_error(CDD_MEMORY);
+    }
+
+    l = s->levels;
+    for (i = 0; i < cdd_levelcnt; i++) {
+        tbl = man->subtables[i];
+        if (tbl == NULL) {
+            continue;
+        }
+        chains = keys = 0;
+        for (j = 0; j < tbl->buckets; j++) {
+            if (tbl->hash[j] != man->sentinel) {
+                chains++;
+                for (node = tbl->hash[j]; node != man->sentinel; node = node->next) {
+                    keys++;
+                }
+            }
+        }
+        l->level = i;
+        l->keys = tbl->keys;
+        l->buckets = tbl->buckets;
+        l->chain = chains ? (double)keys / chains : 0.0;
+        l->lookups = tbl->lookups;
+        l->inserts = tbl->inserts;
+        l++;
+    }
+    return 0;
+}
+
+int32_t cdd_get_stats(cdd_stats* stats)
+{
+    cdd_manager_stats* s;
+    int32_t i, err;
+
+    memset(stats, 0, sizeof(cdd_stats));
+    if (!cdd_running) {
+        return 0;
+    }
+
+    cdd_operator_stats(stats);
+    stats->peak = cdd_peakcnt;
+    stats->gbcnum = cdd_gbccnt;
+    stats->rehashnum = cdd_rehashcnt;
+
+    stats->managernum = 1;
+    for (i = 0; i <= cdd_maxcddused; i++) {
+        stats->managernum += cddmanager[i] != NULL;
+    }
+    stats->managers = (cdd_manager_stats*)calloc(stats->managernum, sizeof(cdd_manager_stats));
+    if (stats->managers == NULL) {
+        stats->managernum = 0;
+        return cdd_error(CDD_MEMORY);
+    }
+
+    s = stats->managers;
+    err = cdd_manager_stats_get(s++, bddmanager, TYPE_BDD, 2);
+    for (i = 0; i <= cdd_maxcddused && err == 0; i++) {
+        if (cddmanager[i]) {
+            err = cdd_manager_stats_get(s++, cddmanager[i], TYPE_CDD, i);
+        }
+    }
+    for (s = stats->managers; s < stats->managers + stats->managernum; s++) {
+        stats->alive += s->alive;
+        stats->dead += s->dead;
+        stats->free += s->free;
+        stats->chunkbytes += s->chunkbytes;
+        stats->reclaims += s->reclaims;
+    }
+    if (err) {
+        cdd_free_stats(stats);
+    }
+    return err;
+}
+
+void cdd_free_stats(cdd_stats* stats)
+{
+    int32_t i;
+
+    for (i = 0; i < stats->managernum; i++) {
+        free(stats->managers[i].levels);
+    }
+    free(stats->managers);
+    stats->managers = NULL;
+    stats->managernum = 0;
+}
+
+/* Resets the counters of a node manager. */
+static void cdd_manager_stats_reset(NodeManager* man)
+{
+    int32_t i;
+
+    man->peakcnt = man->usedcnt + man->deadcnt;
+    man->reclaimcnt = 0;
+    for (i = 0; i < cdd_levelcnt; i++) {
+        if (man->subtables[i]) {
+            man->subtables[i]->lookups = 0;
+            man->subtables[i]->inserts = 0;
+        }
+    }
+}
+
+void cdd_reset_stats()
+{
+    int32_t i;
+
+    if (!cdd_running) {
+        return;
+    }
+    cdd_operator_reset_stats();
+    cdd_peakcnt = cdd_nodecnt;
+    cdd_manager_stats_reset(bddmanager);
+    for (i = 0; i <= cdd_maxcddused; i++) {
+        if (cddmanager[i]) {
+            cdd_manager_stats_reset(cddmanager[i]);
+        }
+    }
+}
+
+/*** REORDERING *****************************************************/
+
+/** Max. growth in percent of the BDD part while sifting a variable. */
+#define MAXGROWTH 120
+
+/* Moves the nodes of a subtable to a list linked by next, leaving the
+ * subtable empty. */
+static ddNode* cdd_detach_subtable(NodeManager* man, SubTable* tbl)
+{
+    ddNode *list = NULL, *node, *next;
+    int32_t j;
+
+    for (j = 0; j < tbl->buckets; j++) {
+        for (node = tbl->hash[j]; node != man->sentinel; node = next) {
+            next = node->next;
+            node->next = list;
+            list = node;
+        }
+        tbl->hash[j] = man->sentinel;
+    }
+    tbl->keys = 0;
+    tbl->deadcnt = 0;
+    return list;
+}
+
+/* Inserts a BDD node into the subtable of its level. */
+static void bdd_insert(bddNode* node)
+{
+    SubTable* tbl = bddmanager->subtables[node->level];
+    bddNode** p = (bddNode**)&(tbl->hash[bddHash(node->low, node->high) >> tbl->shift]);
+
+    while (bdd_cmp(node->low, node->high, *p) < 0) {
+        p = (bddNode**)&((*p)->next);
+    }
+    node->next = (ddNode*)*p;
+    *p = node;
+
+    tbl->keys++;
+    if (tbl->keys > tbl->maxkeys) {
+        cdd_rehash(bddmanager, tbl);
+    }
+}
+
+/* Inserts a CDD node into the subtable of its level. */
+static void cdd_insert(cddNode* node)
+{
+    NodeManager* man = cddmanager[node->len];
+    SubTable* tbl = man->subtables[node->level];
+    cddNode** p;
+
+    if (tbl == NULL) {
+        tbl = cdd_alloc_subtable(man, node->level);
+    }
+    cdd_nodeimage->len = node->len;
+    memcpy(cdd_nodeimage->bnd, node->bnd, cdd_elem_size(node->len));
+    p = (cddNode**)&(tbl->hash[cddHash(cdd_nodeimage) >> tbl->shift]);
+    while (cdd_image_cmp(*p) < 0) {
+        p = (cddNode**)&((*p)->next);
+    }
+    node->next = (ddNode*)*p;
+    *p = node;
+
+    tbl->keys++;
+    if (tbl->keys > tbl->maxkeys) {
+        cdd_rehash(man, tbl);
+    }
+}
+
+/* Frees the nodes that died while swapping. Before and after a swap
+ * no dead nodes exist, so nothing can resurrect the freed nodes. */
+static void cdd_sweep_dead()
+{
+    int32_t i;
+
+    if (bddmanager->deadcnt > 0) {
+        cdd_sweep_nodemanager(bddmanager);
+    }
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        if (cddmanager[i] && cddmanager[i]->deadcnt > 0) {
+            cdd_sweep_nodemanager(cddmanager[i]);
+        }
+    }
+}
+
+/* Exchanges what the levels \a x and \a x + 1 stand for. */
+static void cdd_swap_level_maps(int32_t x)
+{
+    int32_t y = x + 1;
+    int32_t v;
+    LevelInfo info;
+
+    v = cdd_level2var[x];
+    cdd_level2var[x] = cdd_level2var[y];
+    cdd_level2var[y] = v;
+    cdd_var2level[cdd_level2var[x]] = x;
+    cdd_var2level[cdd_level2var[y]] = y;
+
+    info = cdd_levelinfo[x];
+    cdd_levelinfo[x] = cdd_levelinfo[y];
+    cdd_levelinfo[y] = info;
+    if (info.type == TYPE_CDD) {
+        cdd_diff2level[cdd_levelinfo[x].diff] = x;
+        cdd_diff2level[cdd_levelinfo[y].diff] = y;
+    }
+}
+
+/*
+ * Swaps the BDD levels \a x and \a x + 1 in place. Let a be the
+ * variable at x and b the variable at x + 1. Nodes testing b move up
+ * to x and nodes testing a that do not depend on b move down to
+ * x + 1. The other nodes testing a are rewritten in place to
+ *   b ? (a ? f11 : f01) : (a ? f10 : f00),
+ * so every node keeps its function and all references stay valid.
+ */
+static void cdd_swap_bdd_levels(int32_t x)
+{
+    int32_t y = x + 1;
+    bddNode *xs, *ys, *node, *next, *rewrite = NULL;
+    ddNode *f0, *f1, *f00, *f01, *f10, *f11, *low, *high;
+
+    if (bddmanager->subtables[x] == NULL) {
+        cdd_alloc_subtable(bddmanager, x);
+    }
+    if (bddmanager->subtables[y] == NULL) {
+        cdd_alloc_subtable(bddmanager, y);
+    }
+    xs = (bddNode*)cdd_detach_subtable(bddmanager, bddmanager->subtables[x]);
+    ys = (bddNode*)cdd_detach_subtable(bddmanager, bddmanager->subtables[y]);
+
+    for (node = xs; node != NULL; node = next) {
+        next = (bddNode*)node->next;
+        if (cdd_rglr(node->low)->level == y || cdd_rglr(node->high)->level == y) {
+            node->next = (ddNode*)rewrite;
+            rewrite = node;
+        } else {
+            node->level = y;
+            bdd_insert(node);
+        }
+    }
+    for (node = ys; node != NULL; node = next) {
+        next = (bddNode*)node->next;
+        node->level = x;
+        bdd_insert(node);
+    }
+
+    cdd_swap_level_maps(x);
+
+    for (node = rewrite; node != NULL; node = next) {
+        next = (bddNode*)node->next;
+        f0 = node->low;
+        f1 = node->high;
+        if (cdd_rglr(f0)->level == x) {
+            f00 = bdd_low(f0);
+            f01 = bdd_high(f0);
+        } else {
+            f00 = f01 = f0;
+        }
+        if (cdd_rglr(f1)->level == x) {
+            f10 = bdd_low(f1);
+            f11 = bdd_high(f1);
+        } else {
+            f10 = f11 = f1;
+        }
+
+        // The children are regular, since f00 is
+        low = cdd_make_bdd_node(y, f00, f10);
+        cdd_ref(low);
+        high = cdd_make_bdd_node(y, f01, f11);
+        cdd_ref(high);
+        cdd_rec_deref(f0);
+        cdd_rec_deref(f1);
+
+        node->low = low;
+        node->high = high;
+        bdd_insert(node);
+    }
+
+    cdd_sweep_dead();
+}
+
+/* Pushes the elements of \a node within the slice of the difference
+ * tested by \a level that starts above \a low, merging neighbours with
+ * the same child, and returns the upper bound of the slice. Only the
+ * children at \a level depend on that difference. */
+static raw_t cdd_push_slice(cddNode* node, int32_t level, raw_t low)
+{
+    Elem* base = cdd_refstacktop;
+    ddNode** children = cdd_node_child(node);
+    ddNode *child, *c;
+    raw_t up = INF;
+    int32_t i, j;
+
+    for (i = 0; i < (int32_t)node->len; i++) {
+        child = children[i];
+        c = cdd_rglr(child);
+        if (c->level == level) {
+            j = cdd_bnd_seek(cdd_node_bnd(c), 0, cdd_node_len(c) - 1, low + 1);
+            if (cdd_node_bnd(c)[j] < up) {
+                up = cdd_node_bnd(c)[j];
+            }
+            child = cdd_neg_cond(cdd_node_child(c)[j], cdd_mask(child));
+        }
+        if (cdd_refstacktop > base && cdd_refstacktop[-1].child == child) {
+            cdd_refstacktop[-1].bnd = node->bnd[i];
+        } else {
+            cdd_push(child, node->bnd[i]);
+        }
+    }
+    return up;
+}
+
+/* Returns true if \a node has a child at \a level. */
+static int32_t cdd_has_child_at(cddNode* node, int32_t level)
+{
+    ddNode** children = cdd_node_child(node);
+    int32_t i;
+
+    for (i = 0; i < (int32_t)node->len; i++) {
+        if (cdd_rglr(children[i])->level == level) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Returns the number of elements of \a node once the difference at
+ * \a y is tested above it, or 0 if \a node has no child at \a y.
+ * Nothing is created: neighbouring slices with equal elements become
+ * the same node. */
+static int32_t cdd_swap_arity(cddNode* node, int32_t y)
+{
+    Elem *prev = cdd_refstacktop, *cur;
+    int32_t i, n = 0, prevlen = 0, curlen;
+    raw_t low = -INF;
+
+    if (!cdd_has_child_at(node, y)) {
+        return 0;
+    }
+
+    while (low != INF) {
+        cur = cdd_refstacktop;
+        low = cdd_push_slice(node, y, low);
+        curlen = cdd_refstacktop - cur;
+        for (i = 0; i < curlen && i < prevlen && prev[i].child == cur[i].child && prev[i].bnd == cur[i].bnd; i++)
+            ;
+        if (i < curlen || i < prevlen) {
+            n++;
+        }
+        memmove(prev, cur, curlen * sizeof(Elem));
+        prevlen = curlen;
+        cdd_refstacktop = prev + curlen;
+    }
+    cdd_refstacktop = prev;
+    return n;
+}
+
+/* A node that changes arity when two clock difference levels are
+ * swapped, and the node it moves to. */
+typedef struct
+{
+    cddNode* node;
+    cddNode* moved;
+    int32_t parents;  // Number of references from nodes above it
+} Relocation;
+
+static int relocation_compare(const void* a, const void* b)
+{
+    uintptr_t x = (uintptr_t)((const Relocation*)a)->node;
+    uintptr_t y = (uintptr_t)((const Relocation*)b)->node;
+    return (x > y) - (x < y);
+}
+
+/* Counts the references to the \a n relocated nodes from the nodes
+ * above level \a x, or if \a redirect is set, moves them to the new
+ * nodes. Since a moved node keeps the creation number, the parents
+ * keep their place in the subtables. */
+static void cdd_relocate_parents(int32_t x, Relocation* moves, int32_t n, int32_t redirect)
+{
+    NodeManager* man;
+    SubTable* tbl;
+    Relocation key, *r;
+    ddNode *node, **children;
+    int32_t i, level, j, k;
+
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        man = cddmanager[i];
+        if (man == NULL) {
+            continue;
+        }
+        for (level = 0; level < x; level++) {
+            if ((tbl = man->subtables[level]) == NULL) {
+                continue;
+            }
+            for (j = 0; j < tbl->buckets; j++) {
+                for (node = tbl->hash[j]; node != man->sentinel; node = node->next) {
+                    children = cdd_node_child(node);
+                    for (k = 0; k < i; k++) {
+                        key.node = cdd_node(children[k]);
+                        r = bsearch(&key, moves, n, sizeof(Relocation), relocation_compare);
+                        if (r == NULL) {
+                            continue;
+                        }
+                        if (redirect) {
+                            children[k] = cdd_neg_cond((ddNode*)r->moved, cdd_mask(children[k]));
+                        } else {
+                            r->parents++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Rewrites \a node, which tested the difference now at \a y and has
+ * children at \a x, to test the difference at \a x above new nodes
+ * at \a y. Returns the node it now is: \a node itself, or a new node
+ * if the arity changes, which is to replace \a node in its parents. */
+static cddNode* cdd_swap_rewrite(cddNode* node, int32_t x, int32_t y)
+{
+    Elem *top = cdd_refstacktop, *sub, *elem;
+    ddNode** children = cdd_node_child(node);
+    cddNode* res = node;
+    ddNode* child;
+    uintptr_t mask;
+    raw_t low = -INF, up;
+    int32_t i, len;
+
+    while (low != INF) {
+        sub = cdd_refstacktop;
+        up = cdd_push_slice(node, x, low);
+
+        // Normalise, such that the leftmost child is regular
+        mask = cdd_mask(sub->child);
+        for (elem = sub; elem < cdd_refstacktop; elem++) {
+            elem->child = cdd_neg_cond(elem->child, mask);
+        }
+        child = cdd_neg_cond(cdd_make_cdd_node(y, sub, cdd_refstacktop - sub), mask);
+        cdd_refstacktop = sub;
+
+        if (sub > top && sub[-1].child == child) {
+            sub[-1].bnd = up;
+        } else {
+            cdd_ref(child);
+            cdd_push(child, up);
+        }
+        low = up;
+    }
+    len = cdd_refstacktop - top;
+    assert(!cdd_mask(top->child));
+
+    for (i = 0; i < (int32_t)node->len; i++) {
+        cdd_rec_deref(children[i]);
+    }
+    if (len != (int32_t)node->len) {
+        res = (cddNode*)cdd_alloc_node(cdd_arity_manager(len));
+        res->level = node->level;
+        res->type = TYPE_CDD;
+        res->ref = node->ref;
+        res->flag = 0;
+        res->uid = node->uid;
+        res->len = len;
+    }
+    children = cdd_node_child(res);
+    for (i = 0; i < len; i++) {
+        res->bnd[i] = top[i].bnd;
+        children[i] = top[i].child;
+    }
+    cdd_refstacktop = top;
+    cdd_insert(res);
+    return res;
+}
+
+/*
+ * Swaps the clock difference levels \a x and \a x + 1 in place, as
+ * done for BDD levels by cdd_swap_bdd_levels(). Let a be the difference
+ * at x and b the one at x + 1. A node testing a with children testing
+ * b is rewritten to a node testing b, with one child testing a for each
+ * slice of b where the children differ. Nodes of each arity have a
+ * node manager of their own, so a node whose arity changes is moved to
+ * a new node, and its parents are redirected. That is only possible if
+ * all references to it come from other nodes: otherwise nothing is
+ * changed and 0 is returned.
+ */
+static int32_t cdd_swap_cdd_levels(int32_t x)
+{
+    int32_t y = x + 1;
+    int32_t i, j, n, cnt = 0, size = 0;
+    NodeManager* man;
+    SubTable* tbl;
+    cddNode *node, *next, *moved, *down = NULL, *rewrite = NULL;
+    Relocation *moves = NULL, *r, key;
+
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        man = cddmanager[i];
+        if (man == NULL || (tbl = man->subtables[x]) == NULL) {
+            continue;
+        }
+        for (j = 0; j < tbl->buckets; j++) {
+            for (node = (cddNode*)tbl->hash[j]; node != (cddNode*)man->sentinel; node = (cddNode*)node->next) {
+                n = cdd_swap_arity(node, y);
+                if (n == 0 || n == (int32_t)node->len) {
+                    continue;
+                }
+                if (n > cdd_maxcddsize || node->ref == MAXREF) {
+                    free(moves);
+                    return 0;
+                }
+                if (cnt == size) {
+                    size = size ? 2 * size : 16;
+                    r = realloc(moves, size * sizeof(Relocation));
+                    if (r == NULL) {
+                        free(moves);
+                        cdd_error(CDD_MEMORY);
+                        return 0;
+                    }
+                    moves = r;
+                }
+                moves[cnt].node = node;
+                moves[cnt].moved = NULL;
+                moves[cnt].parents = 0;
+                cnt++;
+            }
+        }
+    }
+    if (cnt > 0) {
+        qsort(moves, cnt, sizeof(Relocation), relocation_compare);
+        cdd_relocate_parents(x, moves, cnt, 0);
+        for (i = 0; i < cnt; i++) {
+            if (moves[i].parents != moves[i].node->ref) {
+                free(moves);
+                return 0;
+            }
+        }
+    }
+
+    // Sort out the nodes at x before any node changes level
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        man = cddmanager[i];
+        if (man == NULL || man->subtables[x] == NULL) {
+            continue;
+        }
+        for (node = (cddNode*)cdd_detach_subtable(man, man->subtables[x]); node != NULL; node = next) {
+            next = (cddNode*)node->next;
+            if (cdd_has_child_at(node, y)) {
+                node->next = (ddNode*)rewrite;
+                rewrite = node;
+            } else {
+                node->next = (ddNode*)down;
+                down = node;
+            }
+        }
+    }
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        man = cddmanager[i];
+        if (man == NULL || man->subtables[y] == NULL) {
+            continue;
+        }
+        for (node = (cddNode*)cdd_detach_subtable(man, man->subtables[y]); node != NULL; node = next) {
+            next = (cddNode*)node->next;
+            node->level = x;
+            cdd_insert(node);
+        }
+    }
+    for (node = down; node != NULL; node = next) {
+        next = (cddNode*)node->next;
+        node->level = y;
+        cdd_insert(node);
+    }
+
+    cdd_swap_level_maps(x);
+
+    for (node = rewrite; node != NULL; node = next) {
+        next = (cddNode*)node->next;
+        moved = cdd_swap_rewrite(node, x, y);
+        if (moved != node) {
+            key.node = node;
+            r = bsearch(&key, moves, cnt, sizeof(Relocation), relocation_compare);
+            r->moved = moved;
+        }
+    }
+
+    // Redirect the parents of the moved nodes and free the old nodes
+    if (cnt > 0) {
+        cdd_relocate_parents(x, moves, cnt, 1);
+        for (i = 0; i < cnt; i++) {
+            node = moves[i].node;
+            man = cddmanager[node->len];
+            node->next = man->free;
+            man->free = (ddNode*)node;
+            man->freecnt++;
+            man->usedcnt--;
+            cdd_nodecnt--;
+        }
+    }
+    free(moves);
+
+    cdd_sweep_dead();
+    return 1;
+}
+
+/* Swaps the levels \a x and \a x + 1 of the same type. Returns 0 if
+ * they cannot be swapped in place. */
+static int32_t cdd_swap_any_levels(int32_t x)
+{
+    if (cdd_levelinfo[x].type == TYPE_BDD) {
+        cdd_swap_bdd_levels(x);
+        return 1;
+    }
+    return cdd_swap_cdd_levels(x);
+}
+
+int32_t cdd_swap_levels(int32_t level)
+{
+    int32_t ok;
+
+    if (level < 0 || level + 1 >= cdd_levelcnt || cdd_levelinfo[level].type != cdd_levelinfo[level + 1].type) {
+        return cdd_error(CDD_VAR);
+    }
+
+    // Cached results may depend on the order, and dead nodes must not
+    // be resurrected while swapping
+    cdd_operator_reset();
+    cdd_sweep_dead();
+    cdd_reordering = 1;
+    ok = cdd_swap_any_levels(level);
+    cdd_reordering = 0;
+    return ok ? 0 : cdd_error(CDD_SWAP);
+}
+
+/* Number of nodes in use of the given type */
+static int32_t cdd_used_nodes(int32_t type)
+{
+    int32_t i, cnt = 0;
+
+    if (type == TYPE_BDD) {
+        return bddmanager->usedcnt;
+    }
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        if (cddmanager[i]) {
+            cnt += cddmanager[i]->usedcnt;
+        }
+    }
+    return cnt;
+}
+
+/* Moves the variable at level \a pos through the levels lo to hi and
+ * leaves it at the level where the nodes of its type are fewest. A
+ * direction is given up when a clock difference cannot be swapped. */
+static void cdd_sift(int32_t pos, int32_t lo, int32_t hi)
+{
+    int32_t type = cdd_levelinfo[pos].type;
+    int32_t best = cdd_used_nodes(type);
+    int32_t bestpos = pos;
+    int32_t down = (hi - pos < pos - lo);  // Go to the nearest end first
+    int32_t pass;
+
+    for (pass = 0; pass < 2; pass++, down = !down) {
+        while (down ? pos < hi : pos > lo) {
+            if (!cdd_swap_any_levels(down ? pos : pos - 1)) {
+                break;
+            }
+            pos += down ? 1 : -1;
+            if (cdd_used_nodes(type) < best) {
+                best = cdd_used_nodes(type);
+                bestpos = pos;
+            } else if (100 * cdd_used_nodes(type) > MAXGROWTH * best) {
+                break;
+            }
+        }
+    }
+    for (; pos < bestpos && cdd_swap_any_levels(pos); pos++)
+        ;
+    for (; pos > bestpos && cdd_swap_any_levels(pos - 1); pos--)
+        ;
+}
+
+/* Number of live nodes at a level */
+static int32_t cdd_level_size(int32_t level)
+{
+    SubTable* tbl;
+    int32_t i, cnt = 0;
+
+    if (cdd_levelinfo[level].type == TYPE_BDD) {
+        tbl = bddmanager->subtables[level];
+        return tbl ? tbl->keys - tbl->deadcnt : 0;
+    }
+    for (i = 2; i <= cdd_maxcddused; i++) {
+        if (cddmanager[i] && (tbl = cddmanager[i]->subtables[level]) != NULL) {
+            cnt += tbl->keys - tbl->deadcnt;
+        }
+    }
+    return cnt;
+}
+
+int32_t cdd_reorder()
+{
+    int32_t lo, hi, i, j, n, var;
+    int32_t* vars;
+
+    if (!cdd_running) {
+        return 0;
+    }
+    vars = (int32_t*)malloc(cdd_levelcnt * sizeof(int32_t));
+    if (vars == NULL) {
+        return cdd_error(CDD_MEMORY);
+    }
+
+    cdd_operator_reset();
+    cdd_sweep_dead();
+    cdd_reordering = 1;
+
+    // Sift within each block of consecutive levels of the same type.
+    // The variables with most nodes go first.
+    for (lo = 0; lo < cdd_levelcnt; lo = hi + 1) {
+        for (hi = lo; hi + 1 < cdd_levelcnt && cdd_levelinfo[hi + 1].type == cdd_levelinfo[lo].type; hi++)
+            ;
+        if (lo >= hi) {
+            continue;
+        }
+        n = 0;
+        for (i = lo; i <= hi; i++) {
+            var = cdd_level2var[i];
+            for (j = n++; j > 0 && cdd_level_size(cdd_var2level[vars[j - 1]]) < cdd_level_size(i); j--) {
+                vars[j] = vars[j - 1];
+            }
+            vars[j] = var;
+        }
+        for (i = 0; i < n; i++) {
+            cdd_sift(cdd_var2level[vars[i]], lo, hi);
+        }
+    }
+
+    cdd_reordering = 0;
+    free(vars);
+    return cdd_used_nodes(TYPE_BDD) + cdd_used_nodes(TYPE_CDD);
+}
+
+void cdd_autoreorder(int32_t threshold) { cdd_reorder_threshold = threshold; }
+
 void cdd_dump_nodes()
 {
     SubTable* tbl;
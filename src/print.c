@@ -135,7 +135,7 @@ static void cdd_fprintdot_rec(FILE* ofile, ddNode* r, bool flip_negated, bool ne
     if (cdd_is_negated(r))
         node_color = "red";
 
-    if (cdd_info(r)->type == TYPE_BDD) {
+    if (cdd_node_type(r) == TYPE_BDD) {
         bddNode* node = bdd_node(r);
 
         // We annotate each location in the dot file with a 0 if it was reached with an even number of negations,
@@ -169,7 +169,7 @@ static void cdd_fprintdot_rec(FILE* ofile, ddNode* r, bool flip_negated, bool ne
 
             // Print current node.
             fprintf(ofile, "\"%p%s\" [shape=circle, color = %s, label=\"b%d\"];\n", (void*)r, current_neg_appendix,
-                    node_color, node->level);
+                    node_color, cdd_level2var[node->level]);
 
             // Print arrow to high.
             if (flip_negated && (negated ^ cdd_is_negated(r)) && cdd_isterminal((void*)node->high)) {
@@ -208,7 +208,8 @@ static void cdd_fprintdot_rec(FILE* ofile, ddNode* r, bool flip_negated, bool ne
 
         raw_t bnd = -INF;
         cddNode* node = cdd_node(r);
-        Elem* p = node->elem;
+        const raw_t* p = node->bnd;
+        ddNode** c = cdd_node_child(node);
 
         char* current_neg_appendix = "0";
         char* child_neg_appendix = "0";
@@ -225,7 +226,7 @@ static void cdd_fprintdot_rec(FILE* ofile, ddNode* r, bool flip_negated, bool ne
                 node_color, cdd_info(node)->clock1, cdd_info(node)->clock2);
 
         do {
-            ddNode* child = p->child;
+            ddNode* child = *c;
             if (child != cddfalse) {
                 // Terminal children nodes don't need the annotation.
                 if (child == cddtrue) {
@@ -234,13 +235,14 @@ static void cdd_fprintdot_rec(FILE* ofile, ddNode* r, bool flip_negated, bool ne
 
                 fprintf(ofile, "\"%p%s\" -> \"%p%s\" [style=%s, label=\"", (void*)r, current_neg_appendix,
                         (void*)(child), child_neg_appendix, cdd_mask(child) ? "dashed" : "filled");
-                printInterval(ofile, bnd, p->bnd);
+                printInterval(ofile, bnd, *p);
                 fprintf(ofile, "\"];\n");
 
                 cdd_fprintdot_rec(ofile, child, flip_negated, negated ^ cdd_is_negated(r), a);
             }
-            bnd = p->bnd;
+            bnd = *p;
             p++;
+            c++;
         } while (bnd < INF);
     }
 
@@ -327,10 +329,12 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
 
     if (info->type != TYPE_BDD) {
         cddNode* node = cdd_node(r);
-        Elem* p;
+        const raw_t* p;
+        ddNode** c;
         raw_t bnd;
         int ifstatement = 0;
-        p = node->elem;
+        p = node->bnd;
+        c = cdd_node_child(node);
         bnd = -INF;
         const LevelInfo* levinf = cdd_get_levelinfo(node->level);
 
@@ -341,14 +345,14 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
         }
 
         do {
-            ddNode* child = p->child;
+            ddNode* child = *c;
             if (child != cddfalse) {
                 cdd_freduce_dump_rec(ofile, maskSize, cdd_rglr(child), NULL, labelPrinter, clockPrinter, data,
                                      dotFormat);
                 if (dotFormat) {
                     fprintf(ofile, "\"%p\" -> \"%p\" [style=%s, label=\"", (void*)node, (void*)cdd_rglr(child),
                             cdd_mask(child) ? "dashed" : "filled");
-                    printInterval(ofile, bnd, p->bnd);
+                    printInterval(ofile, bnd, *p);
                     fprintf(ofile, "\"];\n");
                 } else {
                     raw_t lower = bnd_l2u(bnd);
@@ -356,18 +360,19 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
                     ifstatement = 1;
                     clockPrinter(ofile, levinf->clock1, levinf->clock2, data);
                     fprintf(ofile, "%s%d", dbm_rawIsWeak(lower) ? ">=" : ">", -dbm_raw2bound(lower));
-                    if (p->bnd != dbm_LS_INFINITY) {
+                    if (*p != dbm_LS_INFINITY) {
                         fprintf(ofile, " && ");
                         clockPrinter(ofile, levinf->clock1, levinf->clock2, data);
-                        fprintf(ofile, "%s%d", dbm_rawIsWeak(p->bnd) ? "<=" : "<", dbm_raw2bound(p->bnd));
+                        fprintf(ofile, "%s%d", dbm_rawIsWeak(*p) ? "<=" : "<", dbm_raw2bound(*p));
                     }
                     fprintf(ofile, ") goto ");
                     print_node2label(ofile, cdd_rglr(child));
                     fprintf(ofile, ";\n");
                 }
             }
-            bnd = p->bnd;
+            bnd = *p;
             p++;
+            c++;
         } while (bnd < INF);
 
         if (ifstatement) {
@@ -389,7 +394,7 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
                 myInfo.mask[k] = 0;
                 myInfo.value[k] = 0;
             }
-            base_setOneBit(myInfo.mask, node->level);
+            base_setOneBit(myInfo.mask, cdd_level2var[node->level]);
             myInfo.stringFound = false;
             cdd_freduce_dump_rec(ofile, maskSize, node->low, &myInfo, labelPrinter, clockPrinter, data, dotFormat);
 
@@ -401,7 +406,7 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
                 assert(*(myInfo.value) == 0);
                 myInfo.current = node->high;
                 myInfo.other = node->low;
-                base_setOneBit(myInfo.value, node->level);
+                base_setOneBit(myInfo.value, cdd_level2var[node->level]);
                 cdd_freduce_dump_rec(ofile, maskSize, node->high, &myInfo, labelPrinter, clockPrinter, data, dotFormat);
             }
 
@@ -435,7 +440,7 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
             cdd_setmark(r);
         } else {
             parentInfo->stringFound = true;
-            base_setOneBit(parentInfo->mask, node->level);
+            base_setOneBit(parentInfo->mask, cdd_level2var[node->level]);
             if (parentInfo->other == node->high) {
                 parentInfo->current = node->low;
                 cdd_freduce_dump_rec(ofile, maskSize, node->low, parentInfo, labelPrinter, clockPrinter, data,
@@ -444,7 +449,7 @@ static void cdd_freduce_dump_rec(FILE* ofile, int maskSize, ddNode* r, infor* pa
             } else {
                 assert(parentInfo->other == node->low);
                 parentInfo->current = node->high;
-                base_setOneBit(parentInfo->value, node->level);
+                base_setOneBit(parentInfo->value, cdd_level2var[node->level]);
                 cdd_freduce_dump_rec(ofile, maskSize, node->high, parentInfo, labelPrinter, clockPrinter, data,
                                      dotFormat);
                 cdd_freduce_dump_rec(ofile, maskSize, node->low, NULL, labelPrinter, clockPrinter, data, dotFormat);
@@ -23,6 +23,7 @@ int CddRelaxCache_init(CddRelaxCache* cache, int size)
 
     memset(cache->table, 0, sizeof(CddRelaxCacheData) * size);
     cache->tablesize = size;
+    cache->lookups = cache->hits = cache->overwrites = 0;
 
     return 0;
 }
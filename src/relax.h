@@ -18,6 +18,9 @@ typedef struct
 {
     CddRelaxCacheData* table;
     int tablesize;
+    int64_t lookups;
+    int64_t hits;
+    int64_t overwrites;
 } CddRelaxCache;
 
 int CddRelaxCache_init(CddRelaxCache*, int);
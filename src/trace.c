@@ -0,0 +1,177 @@
+// -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+///////////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of the UPPAAL toolkit.
+// Copyright (c) 2011 - 2018, Aalborg University.
+// All right reserved.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/* Ring buffer of traced operations, written out in the JSON object
+ * format of the Chrome trace viewer. Only compiled with CDD_TRACE.
+ */
+
+#include "cdd/kernel.h"
+
+#ifdef CDD_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __MINGW32__
+#ifndef WIN32
+#define WIN32
+#endif
+#endif
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+enum { TRACE_OP, TRACE_GBC, TRACE_REHASH };
+
+typedef struct
+{
+    const char* name;  ///< Name of the event
+    int32_t kind;      ///< TRACE_OP, TRACE_GBC or TRACE_REHASH
+    int32_t arg[4];    ///< Arguments, -1 when not applicable
+    int64_t start;     ///< Start time in ns
+    int64_t duration;  ///< Duration in ns
+} TraceEvent;
+
+/** Names of the arguments of each kind of event. */
+static const char* const trace_argnames[][4] = {{"op", "left", "right", "result"},
+                                                {"nodesize", "freed", "alive", NULL},
+                                                {"level", "buckets", "keys", NULL}};
+
+static TraceEvent* trace_events = NULL; /**< The ring buffer */
+static size_t trace_capacity = 0;       /**< Size of the ring buffer */
+static size_t trace_count = 0;          /**< Number of events recorded */
+static int64_t trace_epoch = 0;         /**< Time of cdd_trace_start() */
+static int32_t trace_depth = 0;         /**< Number of operations in progress */
+static int32_t trace_active = 0;        /**< True while recording */
+
+int64_t cdd_trace_now()
+{
+#ifdef WIN32
+    LARGE_INTEGER freq, cnt;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&cnt);
+    return (cnt.QuadPart / freq.QuadPart) * 1000000000 + (cnt.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static TraceEvent* cdd_trace_record(const char* name, int32_t kind, int64_t start, int32_t a, int32_t b, int32_t c,
+                                    int32_t d)
+{
+    TraceEvent* event = &trace_events[trace_count++ % trace_capacity];
+    event->name = name;
+    event->kind = kind;
+    event->arg[0] = a;
+    event->arg[1] = b;
+    event->arg[2] = c;
+    event->arg[3] = d;
+    event->start = start;
+    event->duration = cdd_trace_now() - start;
+    return event;
+}
+
+/* Operands are counted before the operation, since a garbage
+ * collection during the operation may free unreferenced ones.
+ */
+void cdd_trace_begin(cdd_trace_span* span, ddNode* l, ddNode* r)
+{
+    span->start = -1;
+    if (trace_active && trace_depth == 0) {
+        span->left = l != NULL ? cdd_nodecount(l) : -1;
+        span->right = r != NULL ? cdd_nodecount(r) : -1;
+        span->start = cdd_trace_now();
+    }
+    trace_depth++;
+}
+
+void cdd_trace_end(cdd_trace_span* span, const char* name, int32_t op, ddNode* res)
+{
+    TraceEvent* event;
+
+    trace_depth--;
+    /* Skip operations started before the current cdd_trace_start() */
+    if (trace_active && span->start >= trace_epoch) {
+        event = cdd_trace_record(name, TRACE_OP, span->start, op, span->left, span->right, -1);
+        /* The result is counted after the clock has been read */
+        event->arg[3] = res != NULL ? cdd_nodecount(res) : -1;
+    }
+}
+
+void cdd_trace_gbc(int64_t start, int32_t nodesize, int32_t freed, int32_t alive)
+{
+    if (trace_active) {
+        cdd_trace_record("gbc", TRACE_GBC, start, nodesize, freed, alive, -1);
+    }
+}
+
+void cdd_trace_rehash(int64_t start, int32_t level, int32_t buckets, int32_t keys)
+{
+    if (trace_active) {
+        cdd_trace_record("rehash", TRACE_REHASH, start, level, buckets, keys, -1);
+    }
+}
+
+void cdd_trace_done()
+{
+    free(trace_events);
+    trace_events = NULL;
+    trace_capacity = trace_count = 0;
+    trace_active = 0;
+}
+
+int32_t cdd_trace_start(size_t events)
+{
+    cdd_trace_done();
+    if (events == 0 || (trace_events = (TraceEvent*)malloc(events * sizeof(TraceEvent))) == NULL) {
+        return cdd_error(CDD_MEMORY);
+    }
+    trace_capacity = events;
+    trace_epoch = cdd_trace_now();
+    trace_active = 1;
+    return 0;
+}
+
+void cdd_trace_stop() { trace_active = 0; }
+
+size_t cdd_trace_size() { return trace_count < trace_capacity ? trace_count : trace_capacity; }
+
+int32_t cdd_trace_dump(FILE* out)
+{
+    size_t i, first, size = cdd_trace_size();
+    int32_t j;
+    const char* sep;
+
+    first = trace_count - size;
+    fprintf(out, "{\"traceEvents\":[");
+    for (i = first; i < trace_count; i++) {
+        TraceEvent* event = &trace_events[i % trace_capacity];
+        fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"cdd\",\"ph\":\"X\",\"pid\":1,\"tid\":1", i == first ? "" : ",",
+                event->name);
+        fprintf(out, ",\"ts\":%.3f,\"dur\":%.3f,\"args\":{", (event->start - trace_epoch) / 1000.0,
+                event->duration / 1000.0);
+        sep = "";
+        for (j = 0; j < 4; j++) {
+            if (trace_argnames[event->kind][j] != NULL && event->arg[j] >= 0) {
+                fprintf(out, "%s\"%s\":%d", sep, trace_argnames[event->kind][j], event->arg[j]);
+                sep = ",";
+            }
+        }
+        fprintf(out, "}}");
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":\"%zu\"}}\n", trace_count - size);
+    return ferror(out) ? cdd_error(CDD_FILE) : 0;
+}
+
+#endif
@@ -0,0 +1,555 @@
+/* -*- mode: C++; c-file-style: "stroustrup"; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/*********************************************************************
+ *
+ * This file is a part of the UPPAAL toolkit.
+ * Copyright (c) 2011 - 2022, Aalborg University.
+ * Copyright (c) 1995 - 2003, Uppsala University and Aalborg University.
+ * All right reserved.
+ *
+ *********************************************************************/
+
+/** @file bench_cdd
+ * Benchmarks of the public CDD operations.
+ *
+ * Every combination of the swept numbers of clocks, boolean variables
+ * and zones gets two random states built from the same seed, on which
+ * each operation is timed a few times, starting from cleared operator
+ * caches every time.
+ * The results are written as JSON, one entry per operation and
+ * combination, for comparison between revisions.
+ *
+ * Usage: bench_cdd [--quick] [--seed N] [--repeat N] [--clocks 2,4,...]
+ *                  [--bools 0,4,...] [--zones 10,100,...] [--filter name] [--out file]
+ */
+
+#include "cdd/cdd.h"
+#include "cdd/kernel.h"
+
+#include <dbm/constraints.h>
+#include <dbm/dbm.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+static int64_t elapsed_ns(clock_type::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+}
+
+/** Command line settings. */
+struct settings
+{
+    uint32_t seed = 42;
+    uint32_t repeat = 5;
+    std::vector<uint32_t> clocks{3, 5};  ///< Number of clocks, including the reference clock
+    std::vector<uint32_t> bools{0, 8};   ///< Number of boolean variables
+    std::vector<uint32_t> zones{10, 20}; ///< Number of zones in each state
+    std::string filter;                  ///< Only run benchmarks containing this string
+    const char* out = nullptr;           ///< Output file, stdout if NULL
+};
+
+/** One timed operation for one combination of sizes. */
+struct result
+{
+    std::string name;
+    uint32_t clocks, bools, zones;
+    uint32_t ops;         ///< Operations per repetition
+    int64_t min_ns;       ///< Fastest repetition
+    int64_t median_ns;    ///< Median repetition
+    int32_t nodes;        ///< Nodes of the result, -1 if not applicable
+    int64_t events;       ///< Garbage collections or rehashes, -1 if not applicable
+    int64_t events_ns;    ///< Time spent in them
+};
+
+/** Time spent in garbage collections and rehashes, measured by the hooks. */
+static clock_type::time_point hook_start;
+static int64_t hook_count = 0;
+static int64_t hook_ns = 0;
+
+static void hook_begin() { hook_start = clock_type::now(); }
+
+static void hook_end()
+{
+    hook_ns += elapsed_ns(hook_start);
+    hook_count++;
+}
+
+static void gbc_end(CddGbcStat*) { hook_end(); }
+
+static void rehash_end(CddRehashStat*) { hook_end(); }
+
+static void install_hooks()
+{
+    cdd_pregbc_hook(hook_begin);
+    cdd_postgbc_hook(gbc_end);
+    cdd_prerehash_hook(hook_begin);
+    cdd_postrehash_hook(rehash_end);
+}
+
+/** Random inputs for one combination of sizes, independent of the kernel. */
+struct workload
+{
+    uint32_t clocks, bools, zones;
+    std::vector<raw_t> dbms;     ///< 2 * zones DBMs of dimension clocks
+    std::vector<int8_t> cubes;   ///< 2 * zones cubes of bools literals: 1, -1 or 0 if absent
+
+    const raw_t* dbm(uint32_t i) const { return &dbms[i * clocks * clocks]; }
+    raw_t* dbm(uint32_t i) { return &dbms[i * clocks * clocks]; }
+};
+
+/** Decision diagrams of a workload, valid until cdd_done(). */
+struct states
+{
+    cdd left, right, both, guard, update;
+    cdd safe;  ///< First zone of right, the safe states for cdd_predt()
+};
+
+/**
+ * Generates a non empty closed DBM: every clock gets a lower bound and
+ * an upper bound at most 20 above it, and a few random clock
+ * differences are bounded as well.
+ */
+static void random_dbm(raw_t* dbm, uint32_t dim, std::mt19937& gen)
+{
+    std::vector<raw_t> backup(dim * dim);
+    std::uniform_int_distribution<int32_t> bound(0, 100);
+    std::uniform_int_distribution<int32_t> width(0, 20);
+    std::uniform_int_distribution<uint32_t> clock(1, dim - 1);
+
+    dbm_init(dbm, dim);
+    for (uint32_t i = 1; i < dim; ++i) {
+        int32_t lower = bound(gen);
+        dbm_constrain1(dbm, dim, 0, i, dbm_bound2raw(-lower, dbm_WEAK));
+        dbm_constrain1(dbm, dim, i, 0, dbm_bound2raw(lower + width(gen), dbm_WEAK));
+    }
+    for (uint32_t k = 0; k < dim / 2; ++k) {
+        uint32_t i = clock(gen), j = clock(gen);
+        if (i == j)
+            continue;
+        std::copy(dbm, dbm + dim * dim, backup.begin());
+        if (!dbm_constrain1(dbm, dim, i, j, dbm_bound2raw(bound(gen) - 50, dbm_WEAK)))
+            std::copy(backup.begin(), backup.end(), dbm);
+    }
+}
+
+static void make_workload(workload& w, uint32_t seed)
+{
+    std::mt19937 gen(seed ^ (w.clocks << 20) ^ (w.bools << 10) ^ w.zones);
+    w.dbms.resize(2 * w.zones * w.clocks * w.clocks);
+    w.cubes.resize(2 * w.zones * w.bools);
+    for (uint32_t i = 0; i < 2 * w.zones; ++i) {
+        random_dbm(w.dbm(i), w.clocks, gen);
+        for (uint32_t j = 0; j < w.bools; ++j)
+            w.cubes[i * w.bools + j] = static_cast<int8_t>(gen() % 3) - 1;
+    }
+}
+
+/** Conjunction of zone \a i with its cube. */
+static cdd zone(const workload& w, uint32_t i)
+{
+    cdd res = cdd(w.dbm(i), w.clocks);
+    for (uint32_t j = 0; j < w.bools; ++j) {
+        switch (w.cubes[i * w.bools + j]) {
+        case 1: res &= cdd_bddvarpp(bdd_start_level + j); break;
+        case -1: res &= cdd_bddnvarpp(bdd_start_level + j); break;
+        default: break;
+        }
+    }
+    return res;
+}
+
+/** Union of the zones \a from to \a from + zones - 1. */
+static cdd build_state(const workload& w, uint32_t from)
+{
+    cdd res = cdd_false();
+    for (uint32_t i = from; i < from + w.zones; ++i)
+        res |= zone(w, i);
+    return res;
+}
+
+static void init_kernel(const workload& w, const cdd_options* options)
+{
+    if (options != nullptr)
+        cdd_init_ex(options);
+    else
+        cdd_init(100000, 100000, 100000);
+    install_hooks();
+    cdd_add_clocks(w.clocks);
+    if (w.bools > 0)
+        cdd_add_bddvar(w.bools);
+}
+
+static void build_states(const workload& w, states& st)
+{
+    st.left = build_state(w, 0);
+    st.right = build_state(w, w.zones);
+    st.both = st.left | st.right;
+    st.safe = zone(w, w.zones);
+    st.guard = cdd_intervalpp(1, 0, bnd_lower(10, false), bnd_upper(60, false));
+    st.update = cdd_intervalpp(1, 0, bnd_lower(0, false), bnd_upper(0, false));
+    if (w.bools > 0) {
+        st.guard &= cdd_bddvarpp(bdd_start_level);
+        st.update &= cdd_bddnvarpp(bdd_start_level);
+    }
+}
+
+/** Times \a f, which performs \a ops operations and returns the last result. */
+template <typename F>
+static result measure(const settings& s, const workload& w, const char* name, uint32_t ops, F f)
+{
+    std::vector<int64_t> times;
+    cdd res;
+    int64_t total = 0;
+
+    hook_count = hook_ns = 0;
+    for (uint32_t r = 0; r < s.repeat && (r == 0 || total < 2000000000); ++r) {
+        // Flushing keeps the entries of live nodes, and the result of the
+        // previous repetition and the operands are alive, so clear them all
+        res = cdd_false();
+        cdd_operator_reset();
+        auto start = clock_type::now();
+        res = f();
+        times.push_back(elapsed_ns(start));
+        total += times.back();
+    }
+    std::sort(times.begin(), times.end());
+    return result{name,         w.clocks,  w.bools, w.zones, ops, times.front(), times[times.size() / 2],
+                  cdd_nodecount(res), -1, -1};
+}
+
+static bool selected(const settings& s, const char* name) { return s.filter.empty() || strstr(name, s.filter.c_str()); }
+
+static void run_operations(const settings& s, const workload& w, const states& st, std::vector<result>& results)
+{
+    const uint32_t dim = w.clocks;
+    std::vector<int32_t> exist_bools, resets_bool, values_bool, levels, clocks;
+    int32_t reset_clock[] = {1};
+    int32_t reset_value[] = {0};
+
+    for (uint32_t i = 0; i < w.bools; i += 2)
+        exist_bools.push_back(bdd_start_level + i);
+    if (w.bools > 0) {
+        resets_bool.push_back(bdd_start_level);
+        values_bool.push_back(1);
+    }
+    // Swap neighbouring boolean variables and the first two clocks
+    for (int32_t i = 0; i < cdd_levelcnt; ++i)
+        levels.push_back(i);
+    for (uint32_t i = 0; i + 1 < w.bools; i += 2)
+        std::swap(levels[bdd_start_level + i], levels[bdd_start_level + i + 1]);
+    for (uint32_t i = 0; i < dim; ++i)
+        clocks.push_back(i);
+    if (dim > 2)
+        std::swap(clocks[1], clocks[2]);
+
+    // Points around the zones, evaluated one at a time and all at once
+    constexpr uint32_t n_points = 1000;
+    std::mt19937 gen(s.seed);
+    std::uniform_int_distribution<int32_t> value(0, 130);
+    std::vector<int32_t> point_clocks(n_points * cdd_clocknum, 0);
+    std::unique_ptr<bool[]> point_bools = std::make_unique<bool[]>(n_points * cdd_levelcnt);
+    std::vector<const int32_t*> points;
+    std::vector<const bool*> point_vars;
+    std::vector<int32_t> point_results(n_points);
+    for (uint32_t k = 0; k < n_points; ++k) {
+        for (uint32_t i = 1; i < dim; ++i)
+            point_clocks[k * cdd_clocknum + i] = value(gen);
+        for (uint32_t i = 0; i < w.bools; ++i)
+            point_bools[k * cdd_levelcnt + bdd_start_level + i] = gen() % 2;
+        points.push_back(&point_clocks[k * cdd_clocknum]);
+        point_vars.push_back(&point_bools[k * cdd_levelcnt]);
+    }
+
+    // The zones of right one by one, so that every apply misses the cache
+    std::vector<cdd> right_zones;
+    for (uint32_t i = 0; i < w.zones; ++i)
+        right_zones.push_back(zone(w, w.zones + i));
+
+    auto add = [&](const char* name, uint32_t ops, auto f) {
+        if (selected(s, name))
+            results.push_back(measure(s, w, name, ops, f));
+    };
+
+    add("from_dbm", w.zones, [&] {
+        cdd res;
+        for (uint32_t i = 0; i < w.zones; ++i)
+            res = cdd(w.dbm(i), dim);
+        return res;
+    });
+    add("nodecount", 1, [&] {
+        cdd_nodecount(st.both);
+        return st.both;
+    });
+    add("apply_and", 1, [&] { return st.left & st.right; });
+    add("apply_zones", w.zones, [&] {
+        cdd res;
+        for (uint32_t i = 0; i < w.zones; ++i)
+            res = cdd_apply(st.left, right_zones[i], cddop_and);
+        return res;
+    });
+    add("apply_xor", 1, [&] { return cdd_apply(st.left, st.right, cddop_xor); });
+    add("apply_reduce", 1, [&] { return cdd_apply_reduce(st.left, st.right, cddop_and); });
+    add("reduce", 1, [&] { return cdd_reduce(st.both); });
+    add("reduce2", 1, [&] { return cdd_reduce2(st.both); });
+    add("exist", 1, [&] {
+        return cdd_exist(st.both, exist_bools.data(), reset_clock, static_cast<int32_t>(exist_bools.size()), 1);
+    });
+    add("replace", 1, [&] { return cdd_replace(st.both, levels.data(), clocks.data()); });
+    add("contains", w.zones, [&] {
+        int32_t found = 0;
+        for (uint32_t i = w.zones; i < 2 * w.zones; ++i)
+            found += cdd_contains(st.left, const_cast<raw_t*>(w.dbm(i)), dim);
+        return found > 0 ? cdd_true() : cdd_false();
+    });
+    add("eval_point", n_points, [&] {
+        int32_t found = 0;
+        for (uint32_t k = 0; k < n_points; ++k)
+            found += cdd_eval_point(st.both, points[k], point_vars[k]);
+        return found > 0 ? cdd_true() : cdd_false();
+    });
+    add("eval_points", n_points, [&] {
+        cdd_eval_points(st.both, points.data(), point_vars.data(), n_points, point_results.data());
+        return std::count(point_results.begin(), point_results.end(), 1) > 0 ? cdd_true() : cdd_false();
+    });
+    add("delay", 1, [&] { return cdd_delay(st.both); });
+    // The pasts of the zones overlap near the origin and the result
+    // grows exponentially with their number, so only left is used
+    add("past", 1, [&] { return cdd_past(st.left); });
+    // Timed predecessors grow with the product of the zones of both
+    // arguments, so the safe states are kept to a single zone
+    add("predt", 1, [&] { return cdd_predt(st.left, st.safe); });
+    add("transition", 1, [&] {
+        return cdd_transition(st.both, st.guard, reset_clock, reset_value, 1, resets_bool.data(), values_bool.data(),
+                              static_cast<int32_t>(resets_bool.size()));
+    });
+    add("transition_back", 1, [&] {
+        return cdd_transition_back(st.both, st.guard, st.update, reset_clock, 1, resets_bool.data(),
+                                   static_cast<int32_t>(resets_bool.size()));
+    });
+}
+
+/**
+ * Garbage collections while both states are built ten times over,
+ * with thresholds that let cdd_gbc() collect whenever there are dead
+ * nodes.
+ */
+static void run_gbc(const settings& s, const workload& w, std::vector<result>& results)
+{
+    if (!selected(s, "gbc"))
+        return;
+    std::vector<int64_t> times;
+    int64_t events = 0, events_ns = 0;
+    cdd_options options;
+    cdd_default_options(&options, 100000, 100000, 100000);
+    options.gbc_threshold = 100;
+    options.gbc_minfree = 0;
+
+    init_kernel(w, &options);
+    for (uint32_t r = 0; r < s.repeat; ++r) {
+        hook_count = hook_ns = 0;
+        auto start = clock_type::now();
+        for (uint32_t i = 0; i < 10; ++i) {
+            cdd res = build_state(w, 0) | build_state(w, w.zones);
+            cdd_gbc();
+        }
+        times.push_back(elapsed_ns(start));
+        events = hook_count;
+        events_ns = hook_ns;
+    }
+    cdd_done();
+    std::sort(times.begin(), times.end());
+    results.push_back(
+        result{"gbc", w.clocks, w.bools, w.zones, 10, times.front(), times[times.size() / 2], -1, events, events_ns});
+}
+
+/** Rehashes while both states are built in unique tables starting with 4 buckets. */
+static void run_rehash(const settings& s, const workload& w, std::vector<result>& results)
+{
+    if (!selected(s, "rehash"))
+        return;
+    std::vector<int64_t> times;
+    int64_t events = 0, events_ns = 0;
+    cdd_options options;
+    cdd_default_options(&options, 100000, 100000, 100000);
+    options.buckets = 4;
+
+    for (uint32_t r = 0; r < s.repeat; ++r) {
+        init_kernel(w, &options);
+        hook_count = hook_ns = 0;
+        auto start = clock_type::now();
+        {
+            cdd res = build_state(w, 0) | build_state(w, w.zones);
+        }
+        times.push_back(elapsed_ns(start));
+        events = hook_count;
+        events_ns = hook_ns;
+        cdd_done();
+    }
+    std::sort(times.begin(), times.end());
+    results.push_back(result{"rehash", w.clocks, w.bools, w.zones, 1, times.front(), times[times.size() / 2], -1,
+                             events, events_ns});
+}
+
+/**
+ * Nodes of the union of both states under different initial orders of
+ * the clock differences: as declared, ordered by the clock pairs of the
+ * minimal constraints of the zones, and as declared followed by
+ * sifting. The time is that of building the union, and of sifting.
+ */
+static void run_order(const settings& s, const workload& w, std::vector<result>& results)
+{
+    const uint32_t dim = w.clocks;
+    const char* names[] = {"order_declared", "order_deps", "order_sifted"};
+    std::vector<uint32_t> bits((dim * dim + 31) / 32);
+    std::vector<char> paired(dim * dim, 0);
+    std::vector<int32_t> deps;
+
+    for (uint32_t i = 0; i < 2 * w.zones; ++i) {
+        dbm_analyzeForMinDBM(w.dbm(i), dim, bits.data());
+        for (uint32_t k = 0; k < dim * dim; ++k) {
+            uint32_t a = k / dim, b = k % dim;
+            if (a != b && (bits[k / 32] >> (k % 32) & 1) && !paired[std::min(a, b) * dim + std::max(a, b)]) {
+                paired[std::min(a, b) * dim + std::max(a, b)] = 1;
+                deps.push_back(static_cast<int32_t>(a));
+                deps.push_back(static_cast<int32_t>(b));
+            }
+        }
+    }
+
+    for (uint32_t order = 0; order < 3; ++order) {
+        if (!selected(s, names[order]))
+            continue;
+        std::vector<int64_t> times;
+        int32_t nodes = -1;
+        for (uint32_t r = 0; r < s.repeat; ++r) {
+            cdd_init(100000, 100000, 100000);
+            if (order == 1)
+                cdd_add_clocks_ordered(dim, deps.data(), static_cast<int32_t>(deps.size() / 2));
+            else
+                cdd_add_clocks(dim);
+            if (w.bools > 0)
+                cdd_add_bddvar(w.bools);
+            {
+                auto start = clock_type::now();
+                cdd res = build_state(w, 0) | build_state(w, w.zones);
+                if (order == 2)
+                    cdd_reorder();
+                times.push_back(elapsed_ns(start));
+                nodes = cdd_nodecount(res);
+            }
+            cdd_done();
+        }
+        std::sort(times.begin(), times.end());
+        results.push_back(result{names[order], w.clocks, w.bools, w.zones, 1, times.front(), times[times.size() / 2],
+                                 nodes, -1, -1});
+    }
+}
+
+static void write_json(FILE* out, const settings& s, const std::vector<result>& results)
+{
+    fprintf(out, "{\"benchmark\":\"bench_cdd\",\"seed\":%u,\"repeat\":%u,\"results\":[", s.seed, s.repeat);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const result& r = results[i];
+        fprintf(out,
+                "%s\n{\"name\":\"%s\",\"clocks\":%u,\"bools\":%u,\"zones\":%u,\"ops\":%u,"
+                "\"min_ns\":%lld,\"median_ns\":%lld,\"nodes\":%d",
+                i == 0 ? "" : ",", r.name.c_str(), r.clocks, r.bools, r.zones, r.ops, (long long)r.min_ns,
+                (long long)r.median_ns, r.nodes);
+        if (r.events >= 0)
+            fprintf(out, ",\"events\":%lld,\"events_ns\":%lld", (long long)r.events, (long long)r.events_ns);
+        fprintf(out, "}");
+    }
+    fprintf(out, "\n]}\n");
+}
+
+static std::vector<uint32_t> parse_list(const char* arg)
+{
+    std::vector<uint32_t> res;
+    for (const char* p = arg; *p != '\0';) {
+        char* end;
+        res.push_back(static_cast<uint32_t>(strtoul(p, &end, 10)));
+        p = (*end == ',') ? end + 1 : end + strlen(end);
+    }
+    return res;
+}
+
+static bool parse_args(int argc, char* argv[], settings& s)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            s.repeat = 1;
+            s.clocks = {3};
+            s.bools = {2};
+            s.zones = {10};
+        } else if (i + 1 < argc && arg == "--seed") {
+            s.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (i + 1 < argc && arg == "--repeat") {
+            s.repeat = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+        } else if (i + 1 < argc && arg == "--clocks") {
+            s.clocks = parse_list(argv[++i]);
+        } else if (i + 1 < argc && arg == "--bools") {
+            s.bools = parse_list(argv[++i]);
+        } else if (i + 1 < argc && arg == "--zones") {
+            s.zones = parse_list(argv[++i]);
+        } else if (i + 1 < argc && arg == "--filter") {
+            s.filter = argv[++i];
+        } else if (i + 1 < argc && arg == "--out") {
+            s.out = argv[++i];
+        } else {
+            fprintf(stderr,
+                    "Usage: %s [--quick] [--seed N] [--repeat N] [--clocks 2,4,...] [--bools 0,4,...]\n"
+                    "       [--zones 10,100,...] [--filter name] [--out file]\n",
+                    argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    settings s;
+    std::vector<result> results;
+
+    if (!parse_args(argc, argv, s))
+        return 1;
+    for (uint32_t clocks : s.clocks) {
+        for (uint32_t bools : s.bools) {
+            for (uint32_t zones : s.zones) {
+                workload w{std::max(clocks, 2u), bools, zones, {}, {}};
+                fprintf(stderr, "clocks %u, bools %u, zones %u\n", w.clocks, w.bools, w.zones);
+                make_workload(w, s.seed);
+                init_kernel(w, nullptr);
+                {
+                    states st;
+                    build_states(w, st);
+                    run_operations(s, w, st, results);
+                }
+                cdd_done();
+                run_gbc(s, w, results);
+                run_rehash(s, w, results);
+                run_order(s, w, results);
+            }
+        }
+    }
+
+    FILE* out = s.out != nullptr ? fopen(s.out, "w") : stdout;
+    if (out == nullptr) {
+        perror(s.out);
+        return 1;
+    }
+    write_json(out, s, results);
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
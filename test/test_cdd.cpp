@@ -17,6 +17,7 @@
 #include "cdd/kernel.h"
 
 #include <dbm/dbm.h>
+#include <dbm/fed.h>
 #include <dbm/gen.h>
 #include <dbm/print.h>
 
@@ -27,8 +28,14 @@
 #include <doctest/doctest.h>
 
 #include <iostream>
+#include <memory>
 #include <cstdio>
 #include <cstdlib>
+#include <string>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 using std::endl;
 using std::cerr;
@@ -148,6 +155,38 @@ static void test_conversion(size_t size)
     REQUIRE(cdd_reduce(cdd2) == cdd_false());
 }
 
+static int extract_zones = 0;
+static int extract_zones_greedy = 0;
+
+static void test_extract_dbm_greedy(size_t size)
+{
+    // Create a CDD containing random DBMs.
+    cdd cdd1 = cdd_false();
+    auto dbm = dbm_wrap{size};
+    for (uint32_t i = 0; i < 8; i++) {
+        dbm.generate();
+        cdd1 |= cdd(dbm.raw(), dbm.size());
+    }
+    if (cdd_isterminal(cdd1.handle()))
+        return;
+
+    // Both extractions should split the CDD into zones it contains, the greedy one hopefully into fewer.
+    for (bool greedy : {false, true}) {
+        cdd rest = cdd_reduce(cdd1);
+        cdd zones = cdd_false();
+        int count = 0;
+        while (!cdd_isterminal(rest.handle())) {
+            cdd next = greedy ? cdd_extract_dbm_greedy(rest, dbm.raw(), size) : cdd_extract_dbm(rest, dbm.raw(), size);
+            REQUIRE(cdd_contains(cdd1, dbm.raw(), size));
+            zones |= cdd(dbm.raw(), size);
+            rest = cdd_reduce(next);
+            count++;
+        }
+        REQUIRE(cdd_equiv(zones, cdd1));
+        (greedy ? extract_zones_greedy : extract_zones) += count;
+    }
+}
+
 static void test_extract_bdd(size_t size)
 {
     cdd cdd1, cdd2, cdd3, cdd4;
@@ -182,8 +221,12 @@ static void test_extract_bdd_and_dbm(size_t size)
     REQUIRE(cdd_contains(cdd3, dbm1.raw(), dbm1.size()));
     extraction_result er = cdd_extract_bdd_and_dbm(cdd_reduce(cdd3));
 
-    // Check the result:
-    REQUIRE(dbm_areEqual(er.dbm, dbm1.raw(), size));
+    // Check the result. The extracted DBM has all clocks of the kernel,
+    // which may be more than the generated one has, and none negative.
+    REQUIRE(cdd_equiv(cdd(er.dbm, cdd_clocknum), cdd_remove_negative(cdd1)));
+    if (size == (size_t)cdd_clocknum) {
+        REQUIRE(dbm_areEqual(er.dbm, dbm1.raw(), size));
+    }
     REQUIRE(cdd_equiv(er.BDD_part, cdd2));
     free(er.dbm);
 }
@@ -349,6 +392,22 @@ static void test_remove_negative(size_t size)
     cdd5 = cdd_remove_negative(cdd_true());
     REQUIRE(cdd4 == cdd5);
     REQUIRE(cdd4 != cdd3);
+
+    // Compare with conjoining the lower bounds one by one, on a CDD with negative parts.
+    cdd cdd6 = cdd_false();
+    for (int k = 0; k < 4; k++) {
+        int i = uniform(1, size - 1);
+        int j = uniform(0, size - 1);
+        cdd bounds = cdd_interval(i, 0, -RANGE(), RANGE());
+        if (i != j)
+            bounds &= cdd_upper(i, j, RANGE());
+        cdd6 |= bounds & generate_bdd(size);
+    }
+    cdd cdd7 = cdd6;
+    for (uint32_t i = 1; i < size; i++) {
+        cdd7 &= cdd_interval(i, 0, 0, dbm_LS_INFINITY);
+    }
+    REQUIRE(cdd_equiv(cdd_remove_negative(cdd6), cdd7));
 }
 
 static void test_equiv(size_t size)
@@ -371,10 +430,193 @@ static void test_equiv(size_t size)
     REQUIRE(cdd_equiv(cdd3, cdd4));
 }
 
+static void test_or_n(size_t size)
+{
+    // An odd number of operands also exercises the unpaired operand in the reduction.
+    constexpr auto n_dbms = 7u;
+    cdd parts[n_dbms];
+    cdd disjunction = cdd_false();
+    cdd conjunction = cdd_true();
+    auto dbm = dbm_wrap{size};
+
+    for (auto i = 0u; i < n_dbms; ++i) {
+        dbm.generate();
+        parts[i] = cdd(dbm.raw(), dbm.size()) & generate_bdd(size);
+        disjunction |= parts[i];
+        conjunction &= parts[i];
+    }
+
+    REQUIRE(cdd_equiv(cdd_or_n(parts, n_dbms), disjunction));
+    REQUIRE(cdd_equiv(cdd_and_n(parts, n_dbms), conjunction));
+
+    // Degenerate cases.
+    REQUIRE(cdd_or_n(parts, 0) == cdd_false());
+    REQUIRE(cdd_and_n(parts, 0) == cdd_true());
+    REQUIRE(cdd_or_n(parts, 1) == parts[0]);
+}
+
+static void test_from_dbms(size_t size)
+{
+    constexpr auto n_dbms = 16u;
+    std::vector<dbm_wrap> dbms(n_dbms, dbm_wrap{size});
+    std::vector<const raw_t*> raws;
+    cdd expected = cdd_false();
+
+    for (auto& dbm : dbms) {
+        dbm.generate();
+        raws.push_back(dbm.raw());
+        expected |= cdd(dbm.raw(), dbm.size());
+    }
+    // Duplicated zones must not change the result.
+    raws.push_back(dbms.front().raw());
+
+    cdd result = cdd(cdd_from_dbms(raws.data(), raws.size(), size));
+    REQUIRE(cdd_equiv(result, expected));
+    for (auto& dbm : dbms) {
+        REQUIRE(cdd_contains(result, dbm.raw(), dbm.size()));
+    }
+
+    // Batch inclusion checks agree with one query at a time.
+    std::vector<dbm_wrap> queries(n_dbms, dbm_wrap{size});
+    for (auto& query : queries) {
+        query.generate();
+        raws.push_back(query.raw());
+    }
+    for (const cdd& c : {result, result & generate_bdd(size), cdd_true(), cdd_false()}) {
+        std::vector<int32_t> results(raws.size());
+        cdd_contains_many(c, raws.data(), raws.size(), size, results.data());
+        for (auto i = 0u; i < raws.size(); ++i) {
+            REQUIRE(results[i] == cdd_contains(c, const_cast<raw_t*>(raws[i]), size));
+        }
+    }
+    raws.resize(n_dbms + 1);
+
+    // Degenerate cases.
+    REQUIRE(cdd(cdd_from_dbms(raws.data(), 0, size)) == cdd_false());
+    REQUIRE(cdd(cdd_from_dbms(raws.data(), 1, size)) == cdd(raws[0], size));
+}
+
+static void test_eval_point(size_t size)
+{
+    constexpr auto n_points = 64u;
+    auto dbm1 = dbm_wrap{size};
+    auto dbm2 = dbm_wrap{size};
+    dbm1.generate();
+    dbm2.generate();
+    cdd c = (cdd(dbm1.raw(), size) | cdd(dbm2.raw(), size)) & generate_bdd(size);
+
+    // Points within the range of the generated bounds, with every clock
+    // beyond the dimension left at 0.
+    std::vector<std::vector<int32_t>> points(n_points, std::vector<int32_t>(cdd_clocknum, 0));
+    std::vector<std::unique_ptr<bool[]>> bools;
+    std::vector<const int32_t*> clocks;
+    std::vector<const bool*> bool_ptrs;
+    for (auto k = 0u; k < n_points; ++k) {
+        for (auto i = 1u; i < size; ++i)
+            points[k][i] = uniform(0, 2 * RANGE());
+        bools.push_back(std::make_unique<bool[]>(cdd_levelcnt));
+        for (auto i = 0u; i < size; ++i)
+            bools[k][bdd_start_level + i] = binomial();
+        clocks.push_back(points[k].data());
+        bool_ptrs.push_back(bools[k].get());
+    }
+
+    std::vector<int32_t> results(n_points);
+    cdd_eval_points(c, clocks.data(), bool_ptrs.data(), n_points, results.data());
+    auto point = dbm_wrap{size};
+    for (auto k = 0u; k < n_points; ++k) {
+        // The point as a zone, within the boolean valuation as a cube.
+        for (auto i = 0u; i < size; ++i)
+            for (auto j = 0u; j < size; ++j)
+                point.raw()[i * size + j] = dbm_bound2raw(points[k][i] - points[k][j], dbm_WEAK);
+        cdd cube = cdd_true();
+        for (auto i = 0u; i < size; ++i)
+            cube &= bools[k][bdd_start_level + i] ? cdd_bddvarpp(bdd_start_level + i)
+                                                  : cdd_bddnvarpp(bdd_start_level + i);
+        bool expected = cdd_contains(cdd_reduce(c & cube), point.raw(), size);
+        REQUIRE(cdd_eval_point(c, points[k].data(), bools[k].get()) == expected);
+        REQUIRE(results[k] == expected);
+    }
+
+    REQUIRE(cdd_eval_point(cdd_true(), clocks[0], bool_ptrs[0]));
+    REQUIRE(!cdd_eval_point(cdd_false(), clocks[0], bool_ptrs[0]));
+}
+
+static void test_zone_iterator(size_t size)
+{
+    constexpr auto n_dbms = 5u;
+    cdd state = cdd_false();
+    auto dbm = dbm_wrap{size};
+
+    for (auto i = 0u; i < n_dbms; ++i) {
+        dbm.generate();
+        state |= cdd(dbm.raw(), dbm.size()) & generate_bdd(size);
+    }
+
+    // The zones are consistent, contained in the state and cover it.
+    cdd rebuilt = cdd_false();
+    ddNode* bottom;
+    cdd_zone_iterator it;
+    cdd_zone_iterator_init(&it, state.handle(), size);
+    while (cdd_zone_iterator_next(&it, dbm.raw(), &bottom)) {
+        REQUIRE(dbm_isValid(dbm.raw(), size));
+        cdd zone = cdd(dbm.raw(), size) & cdd(bottom);
+        REQUIRE(cdd_equiv(zone & !state, cdd_false()));
+        rebuilt |= zone;
+    }
+    cdd_zone_iterator_done(&it);
+    REQUIRE(cdd_equiv(rebuilt, state));
+
+    // The false diagram has no zones, the true diagram a single one.
+    cdd_zone_iterator_init(&it, cdd_false().handle(), size);
+    REQUIRE(cdd_zone_iterator_next(&it, dbm.raw(), &bottom) == 0);
+    cdd_zone_iterator_done(&it);
+    cdd_zone_iterator_init(&it, cdd_true().handle(), size);
+    REQUIRE(cdd_zone_iterator_next(&it, dbm.raw(), &bottom) == 1);
+    REQUIRE(bottom == cdd_true().handle());
+    REQUIRE(cdd_zone_iterator_next(&it, dbm.raw(), &bottom) == 0);
+    cdd_zone_iterator_done(&it);
+}
+
 int strict(int inputNumber) { return inputNumber * 2; }
 
 int nstrict(int inputNumber) { return inputNumber * 2 + 1; }
 
+static double time_delay = 0;
+static double time_delay_zones = 0;
+
+/* Splitting a diagram into zones takes time exponential in its number
+ * of clocks, so the checks against a zone by zone computation are left
+ * out for the diagrams of more clocks than this. Otherwise they make
+ * up nearly all of the time of the size 10 big test.
+ */
+static constexpr size_t max_zones_size = 3;
+
+/* Reference implementation of the delay (or past), which delays the
+ * zones of the CDD one at a time.
+ */
+static cdd delay_by_zones(const cdd& state, bool past = false)
+{
+    if (cdd_isBDD(state))
+        return state;
+
+    std::vector<cdd> parts;
+    std::vector<raw_t> dbm(cdd_clocknum * cdd_clocknum);
+    ddNode* bottom;
+    cdd_zone_iterator it;
+    cdd_zone_iterator_init(&it, state.handle(), cdd_clocknum);
+    while (cdd_zone_iterator_next(&it, dbm.data(), &bottom)) {
+        if (past) {
+            dbm_down(dbm.data(), cdd_clocknum);
+        } else {
+            dbm_up(dbm.data(), cdd_clocknum);
+        }
+        parts.push_back(cdd(dbm.data(), cdd_clocknum) & cdd(bottom));
+    }
+    cdd_zone_iterator_done(&it);
+    return cdd_or_n(parts.data(), parts.size());
+}
+
 void test_delay(size_t size)
 {
     // First some trivial cases.
@@ -403,6 +645,16 @@ void test_delay(size_t size)
 
     // The delay operator should not influence the BDD part.
     REQUIRE(cdd_equiv(cdd_delay(result3), result2 & bdd_part));
+
+    // Compare with delaying zone by zone.
+    if (size > max_zones_size)
+        return;
+    Timer timer;
+    cdd structural = cdd_delay(result3);
+    time_delay += timer.getElapsed();
+    cdd by_zones = delay_by_zones(result3);
+    time_delay_zones += timer.getElapsed();
+    REQUIRE(cdd_equiv(structural, by_zones));
 }
 
 void test_delay_invariant(size_t size)
@@ -436,6 +688,16 @@ void test_delay_invariant(size_t size)
 
     // The delay operator should not influence the BDD part.
     REQUIRE(cdd_equiv(cdd_delay_invariant(result3, cdd_true()), result2 & bdd_part));
+
+    // Restricting by the invariant during the delay is the same as restricting afterwards.
+    dbm.generate();
+    cdd invar = cdd(dbm.raw(), dbm.size()) | generate_bdd(size);
+    REQUIRE(cdd_equiv(cdd_delay_invariant(result3, invar), cdd_delay(result3) & invar));
+
+    // The bounds of a negated invariant come from the children that are
+    // not true.
+    invar = !cdd(dbm.raw(), dbm.size());
+    REQUIRE(cdd_equiv(cdd_delay_invariant(result3, invar), cdd_delay(result3) & invar));
 }
 
 void test_past(size_t size)
@@ -466,6 +728,11 @@ void test_past(size_t size)
 
     // The delay operator should not influence the BDD part.
     REQUIRE(cdd_equiv(cdd_past(result3), result2 & bdd_part));
+
+    // Compare with computing the past zone by zone.
+    if (size > max_zones_size)
+        return;
+    REQUIRE(cdd_equiv(cdd_past(result3), delay_by_zones(result3, true)));
 }
 
 void test_exist(size_t size)
@@ -523,6 +790,22 @@ void test_exist(size_t size)
     REQUIRE(cdd_equiv(result1, result4));
     REQUIRE(cdd_equiv(result1, result6));
     REQUIRE(cdd_equiv(result4, result6));
+
+    // Repeating the quantification, also with the variables listed twice,
+    // should be answered from the cache with the identical diagram.
+    int bools_twice[2] = {arr1[0], arr1[0]};
+    int clocks_twice[2] = {arr[0], arr[0]};
+    cdd result7 = cdd_exist(result, boolPtr, clockPtr, num_bools, num_clocks);
+    cdd result8 = cdd_exist(result, bools_twice, clocks_twice, 2, 2);
+    REQUIRE(result7 == result8);
+    REQUIRE(cdd_equiv(cdd_reduce(result7), result1));
+
+    // Quantifying the conjunction without building it should agree, in
+    // either order of the operands.
+    cdd result9 = cdd(cdd_and_exist(cdd_part.handle(), bdd_part.handle(), boolPtr, clockPtr, num_bools, num_clocks));
+    REQUIRE(cdd_equiv(cdd_reduce(result9), result1));
+    REQUIRE(cdd(cdd_and_exist(bdd_part.handle(), cdd_part.handle(), boolPtr, clockPtr, num_bools, num_clocks)) ==
+            result9);
 }
 
 void test_apply_reset(size_t size)
@@ -581,6 +864,30 @@ void test_apply_reset(size_t size)
     // Check the result.
     REQUIRE(cdd_equiv(result1, result1 & update));
     REQUIRE(cdd_equiv(cdd_false(), result1 & !update));
+
+    // A state without clock constraints is still restricted to the
+    // non-negative clocks, so the reset clock gets its value as well.
+    REQUIRE(cdd_equiv(cdd_apply_reset(bdd_part, clockPtr, clock_values, num_clocks, nullptr, nullptr, 0),
+                      cdd_remove_negative(bdd_part) & cdd_intervalpp(clockPtr[0], 0, 0, 1)));
+    REQUIRE(cdd_equiv(cdd_apply_reset(cdd_false(), clockPtr, clock_values, num_clocks, nullptr, nullptr, 0),
+                      cdd_false()));
+
+    // Compare the clock reset with resetting each zone.
+    if (size > max_zones_size)
+        return;
+    int value = uniform(0, 10);
+    cdd state = cdd_remove_negative(cdd1);
+    std::vector<cdd> parts;
+    std::vector<raw_t> zone(cdd_clocknum * cdd_clocknum);
+    ddNode* bottom;
+    cdd_zone_iterator it;
+    cdd_zone_iterator_init(&it, state.handle(), cdd_clocknum);
+    while (cdd_zone_iterator_next(&it, zone.data(), &bottom)) {
+        dbm_updateValue(zone.data(), cdd_clocknum, clock_num, value);
+        parts.push_back(cdd(zone.data(), cdd_clocknum) & cdd(bottom));
+    }
+    cdd_zone_iterator_done(&it);
+    REQUIRE(cdd_equiv(cdd_reset(state, clockPtr, &value, num_clocks), cdd_or_n(parts.data(), parts.size())));
 }
 
 void test_transition(size_t size)
@@ -707,8 +1014,24 @@ void test_transition_back(size_t size)
 
     // Transitioning forward again should be included in the original start CDD.
     // Remember that cdd1 \subset cdd2 <==> cdd1 & !cdd2 == false
-    REQUIRE((!cdd1 & cdd_transition(result1, guard, clockPtr, clock_values, num_clocks, boolPtr, bool_values,
-                                    num_bools)) == cdd_false());
+    REQUIRE(cdd_reduce(!cdd1 & cdd_transition(result1, guard, clockPtr, clock_values, num_clocks, boolPtr,
+                                              bool_values, num_bools)) == cdd_false());
+
+    // Compare with freeing the clock in each zone.
+    if (size > max_zones_size)
+        return;
+    cdd enabled = cdd_exist(cdd_remove_negative(cdd1 & update), boolPtr, nullptr, num_bools, 0);
+    std::vector<cdd> parts;
+    std::vector<raw_t> zone(cdd_clocknum * cdd_clocknum);
+    ddNode* bottom;
+    cdd_zone_iterator it;
+    cdd_zone_iterator_init(&it, enabled.handle(), cdd_clocknum);
+    while (cdd_zone_iterator_next(&it, zone.data(), &bottom)) {
+        dbm_freeClock(zone.data(), cdd_clocknum, clock_num);
+        parts.push_back(cdd(zone.data(), cdd_clocknum) & cdd(bottom));
+    }
+    cdd_zone_iterator_done(&it);
+    REQUIRE(cdd_equiv(result1, cdd_or_n(parts.data(), parts.size()) & guard));
 }
 
 void test_transition_back_past(size_t size)
@@ -770,13 +1093,45 @@ void test_transition_back_past(size_t size)
     // Check the result.
     REQUIRE(cdd_equiv(result1, result1 & guard));
     REQUIRE(cdd_equiv(cdd_false(), result1 & !guard));
-    REQUIRE(cdd_equiv(result1,
-                      cdd_past(cdd_transition_back(cdd1, guard, update, clockPtr, num_clocks, boolPtr, num_bools))));
+    cdd back = cdd_transition_back(cdd1, guard, update, clockPtr, num_clocks, boolPtr, num_bools);
+    REQUIRE(cdd_equiv(result1, cdd_past(back)));
 
-    // Transitioning forward again should be included in the original start CDD.
+    // Transitioning forward again from the states that need no delay should be included in the
+    // original start CDD. From the earlier states, the clocks that are not reset end up lower.
     // Remember that cdd1 \subset cdd2 <==> cdd1 & !cdd2 == false
-    REQUIRE((!cdd1 & cdd_transition(result1, guard, clockPtr, clock_values, num_clocks, boolPtr, bool_values,
-                                    num_bools)) == cdd_false());
+    REQUIRE(cdd_reduce(!cdd1 & cdd_transition(result1 & back, guard, clockPtr, clock_values, num_clocks, boolPtr,
+                                              bool_values, num_bools)) == cdd_false());
+}
+
+// Computes the timed predecessor by enumerating every boolean valuation.
+static cdd predt_by_valuations(const cdd& target, const cdd& safe)
+{
+    std::vector<cdd> parts;
+    std::vector<raw_t> dbm(cdd_clocknum * cdd_clocknum);
+    ddNode* bottom;
+    cdd_zone_iterator it;
+    for (auto i = 0u; i < (1u << cdd_varnum); ++i) {
+        cdd valuation = cdd_true();
+        for (auto j = 0u; j < cdd_varnum; ++j) {
+            valuation &= (i & 1 << j) ? cdd_bddvarpp(bdd_start_level + j) : cdd_bddnvarpp(bdd_start_level + j);
+        }
+        auto bad_fed = dbm::fed_t{(uint32_t)cdd_clocknum};
+        auto good_fed = dbm::fed_t{(uint32_t)cdd_clocknum};
+        cdd_zone_iterator_init(&it, (target & valuation).handle(), cdd_clocknum);
+        while (cdd_zone_iterator_next(&it, dbm.data(), &bottom)) {
+            bad_fed.add(dbm.data(), cdd_clocknum);
+        }
+        cdd_zone_iterator_done(&it);
+        cdd_zone_iterator_init(&it, (safe & valuation).handle(), cdd_clocknum);
+        while (cdd_zone_iterator_next(&it, dbm.data(), &bottom)) {
+            good_fed.add(dbm.data(), cdd_clocknum);
+        }
+        cdd_zone_iterator_done(&it);
+        for (auto& zone : bad_fed.predt(good_fed)) {
+            parts.push_back(cdd(zone.const_dbm(), cdd_clocknum) & valuation);
+        }
+    }
+    return cdd_or_n(parts.data(), parts.size());
 }
 
 void test_predt(size_t size)
@@ -803,12 +1158,12 @@ void test_predt(size_t size)
 
     // First some checks when nothing can save us.
     // cdd_part \subset cdd_predt(cdd_part) <==> cdd_part & !cdd_predt(cdd_part) == false
-    REQUIRE((!cdd_predt(cdd_part, cdd_false()) & cdd_remove_negative(cdd_part)) == cdd_false());
+    REQUIRE(cdd_reduce(!cdd_predt(cdd_part, cdd_false()) & cdd_remove_negative(cdd_part)) == cdd_false());
     // cdd_predt(cdd_part) \subset cdd_past(cdd_part) <==> cdd_predt(cdd_part) & !cdd_past(cdd_part) == false
-    REQUIRE((!cdd_past(cdd_part) & cdd_predt(cdd_part, cdd_false())) == cdd_false());
+    REQUIRE(cdd_reduce(!cdd_past(cdd_part) & cdd_predt(cdd_part, cdd_false())) == cdd_false());
     REQUIRE(cdd_equiv(cdd_predt(bdd_part, cdd_false()), cdd_remove_negative(bdd_part)));
     // cdd_predt(cdd1) \subset cdd_past(cdd1) <==> cdd_predt(cdd1) & !cdd_past(cdd1) == false
-    REQUIRE((!cdd_past(cdd1) & cdd_predt(cdd1, cdd_false())) == cdd_false());
+    REQUIRE(cdd_reduce(!cdd_past(cdd1) & cdd_predt(cdd1, cdd_false())) == cdd_false());
     REQUIRE(cdd_equiv(cdd_predt(cdd1, cdd_true()), cdd_false()));
 
     // Check timed predecessor for random, but non-overlapping safe cdd.
@@ -825,6 +1180,21 @@ void test_predt(size_t size)
     cdd right = cdd2_part & !b1;
     cdd test = left | right;
     REQUIRE(cdd_equiv(cdd_predt(test, right), cdd_remove_negative(cdd_past(left))));
+
+    // Computing the pieces on several threads should give the same result.
+    REQUIRE(cdd_equiv(cdd_predt(test, right, 4), cdd_predt(test, right)));
+
+    // Compare with enumerating all boolean valuations for an overlapping safe cdd.
+    // The enumeration is exponential in the number of booleans, so skip it for the big diagrams.
+    if (cdd_varnum > 6)
+        return;
+    cdd safe = cdd_false();
+    for (uint32_t i = 0; i < n_dbms; i++) {
+        dbm.generate();
+        safe |= cdd(dbm.raw(), dbm.size()) & generate_bdd(size);
+    }
+    REQUIRE(cdd_equiv(cdd_predt(cdd1, safe), predt_by_valuations(cdd1, safe)));
+    REQUIRE(cdd_equiv(cdd_predt(cdd1, safe, 4), cdd_predt(cdd1, safe)));
 }
 
 void test_bdd_to_array(size_t size)
@@ -877,6 +1247,13 @@ static void big_test(uint32_t n)
             test("test_apply_reduce", test_apply_reduce, i);
             test("test_reduce      ", test_reduce, i);
             test("test_equiv       ", test_equiv, i);
+            test("test_or_n        ", test_or_n, i);
+            test("test_from_dbms   ", test_from_dbms, i);
+            test("test_eval_point  ", test_eval_point, i);
+            if (i <= max_zones_size) {
+                test("test_zone_iterator", test_zone_iterator, i);
+                test("test_extract_dbm_greedy", test_extract_dbm_greedy, i);
+            }
             test("test_extract_bdd ", test_extract_bdd, i);
             test("test_extract_bdd_and_dbm", test_extract_bdd_and_dbm, i);
             test("test_delay       ", test_delay, i);
@@ -905,6 +1282,8 @@ static void big_test(uint32_t n)
            dbm_wrap::get_allDBMs() ? (100 * dbm_wrap::get_goodDBMs()) / dbm_wrap::get_allDBMs() : 0);
     printf("apply+reduce: %.3fs, apply_reduce: %.3fs\n", time_apply_and_reduce, time_apply_reduce);
     printf("reduce: %.3fs, bf_reduce: %.3fs\n", time_reduce, time_bf);
+    printf("delay: %.3fs, delay by zones: %.3fs\n", time_delay, time_delay_zones);
+    printf("extract: %d zones, greedy extract: %d zones\n", extract_zones, extract_zones_greedy);
     printf("Passed\n");
 }
 
@@ -917,6 +1296,603 @@ TEST_CASE("CDD intersection with size 3")
     cdd_done();
 }
 
+TEST_CASE("CDD replace keeps operation ids fresh")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(3);
+    int32_t b = cdd_add_bddvar(1);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        cdd state = cdd_intervalpp(1, 0, bnd_lower(2, false), bnd_upper(4, false)) &
+                    cdd_intervalpp(2, 0, bnd_lower(1, false), bnd_upper(3, false)) & cdd_bddvarpp(b);
+        std::vector<int32_t> levels(cdd_levelcnt);
+        std::vector<int32_t> clocks(cdd_clocknum);
+        for (int32_t i = 0; i < cdd_levelcnt; ++i)
+            levels[i] = i;
+        for (int32_t i = 0; i < cdd_clocknum; ++i)
+            clocks[i] = i;
+
+        // The second replace reuses the interned id of the first. The
+        // past must not get the id of the delay in between and hit its
+        // cache entries.
+        cdd replaced = cdd_replace(state, levels.data(), clocks.data());
+        cdd delayed = cdd_delay(state);
+        replaced = cdd_replace(state, levels.data(), clocks.data());
+        cdd past = cdd_past(state);
+        REQUIRE(cdd_equiv(replaced, state));
+        REQUIRE(cdd_equiv(delayed, delay_by_zones(state)));
+        REQUIRE(cdd_equiv(past, delay_by_zones(state, true)));
+    }
+    cdd_done();
+}
+
+TEST_CASE("CDD wide nodes")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(2);
+    cdd_add_bddvar(1);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        // A comb of 200 intervals x in [4k, 4k+2] on a single node.
+        cdd comb = cdd_false();
+        for (int32_t k = 0; k < 200; ++k)
+            comb |= cdd_intervalpp(1, 0, bnd_lower(4 * k, false), bnd_upper(4 * k + 2, false));
+        REQUIRE(cdd_node_len(comb.handle()) == 401);
+
+        // Conjunction with a narrow window only keeps the teeth inside it.
+        cdd window = cdd_intervalpp(1, 0, bnd_lower(101, false), bnd_upper(109, false));
+        cdd expected = cdd_intervalpp(1, 0, bnd_lower(101, false), bnd_upper(102, false)) |
+                       cdd_intervalpp(1, 0, bnd_lower(104, false), bnd_upper(106, false)) |
+                       cdd_intervalpp(1, 0, bnd_lower(108, false), bnd_upper(109, false));
+        REQUIRE(cdd_equiv(comb & window, expected));
+        REQUIRE(cdd_equiv(window & comb, expected));
+        REQUIRE(cdd_equiv(comb & !window, comb & !expected));
+
+        bool bools[8] = {};
+        for (int32_t x = 0; x < 810; ++x) {
+            int32_t clocks[2] = {0, x};
+            REQUIRE(cdd_eval_point(comb, clocks, bools) == (x % 4 <= 2 && x < 800));
+        }
+    }
+    cdd_done();
+}
+
+TEST_CASE("CDD greedy extraction needs fewer zones")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(3);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        // Two boxes that overlap on x. The path of cdd_extract_dbm() only
+        // covers x in [5,10) of the upper box, while the greedy extraction
+        // widens it to all of x in [5,15].
+        cdd box1 = cdd_intervalpp(1, 0, bnd_lower(10, false), bnd_upper(15, false)) &
+                   cdd_intervalpp(2, 0, bnd_lower(5, false), bnd_upper(10, false));
+        cdd box2 = cdd_intervalpp(1, 0, bnd_lower(5, false), bnd_upper(15, false)) &
+                   cdd_intervalpp(2, 0, bnd_lower(15, false), bnd_upper(25, false));
+        cdd state = box1 | box2;
+        std::vector<raw_t> dbm(cdd_clocknum * cdd_clocknum);
+        int count[2] = {0, 0};
+        for (bool greedy : {false, true}) {
+            cdd rest = cdd_reduce(state);
+            cdd zones = cdd_false();
+            while (!cdd_isterminal(rest.handle())) {
+                cdd next = greedy ? cdd_extract_dbm_greedy(rest, dbm.data(), cdd_clocknum)
+                                  : cdd_extract_dbm(rest, dbm.data(), cdd_clocknum);
+                REQUIRE(cdd_contains(state, dbm.data(), cdd_clocknum));
+                zones |= cdd(dbm.data(), cdd_clocknum);
+                rest = cdd_reduce(next);
+                count[greedy]++;
+            }
+            REQUIRE(cdd_equiv(zones, state));
+        }
+        REQUIRE(count[0] == 3);
+        REQUIRE(count[1] == 2);
+    }
+    cdd_done();
+}
+
+TEST_CASE("CDD delay right after initialisation")
+{
+    // The first restriction to non-negative clocks interns a new
+    // operation id, which must not be reused by the delay itself.
+    for (int32_t past = 0; past < 2; ++past) {
+        cdd_init(100000, 10000, 10000);
+        cdd_add_clocks(3);
+        int32_t b = cdd_add_bddvar(1);
+
+        // TODO see issue #36 for this namespace and cdd_done() stuff.
+        {
+            cdd state = cdd_intervalpp(1, 0, bnd_lower(2, false), bnd_upper(4, false)) &
+                        cdd_intervalpp(2, 0, bnd_lower(1, false), bnd_upper(3, false)) & cdd_bddvarpp(b);
+            cdd timed = past ? cdd_past(state) : cdd_delay(state);
+            REQUIRE(cdd_equiv(timed, delay_by_zones(state, past)));
+        }
+        cdd_done();
+    }
+}
+
+/// Builds a fixed diagram and returns the keys of the results, and their sizes in \a sizes.
+static std::vector<uint32_t> build_keyed_diagram(std::vector<int32_t>& sizes)
+{
+    std::vector<uint32_t> keys;
+    cdd c = cdd_false();
+    for (int32_t k = 0; k < 20; ++k) {
+        cdd zone = cdd_intervalpp(1, 0, bnd_lower(k, false), bnd_upper(3 * k + 5, false)) &
+                   cdd_intervalpp(2, 1, bnd_lower(-k, true), bnd_upper(k, true));
+        c |= (k % 2 ? cdd_bddvarpp(bdd_start_level) : cdd_bddnvarpp(bdd_start_level + 1)) & zone;
+        keys.push_back(cdd_node_key(c.handle()));
+        sizes.push_back(cdd_nodecount(c));
+    }
+    cdd reduced = cdd_reduce(c);
+    keys.push_back(cdd_node_key(reduced.handle()));
+    sizes.push_back(cdd_nodecount(reduced));
+    keys.push_back(cdd_node_key(c.handle()));
+    keys.push_back(cdd_node_key((!c).handle()));
+    return keys;
+}
+
+TEST_CASE("CDD node keys do not depend on addresses")
+{
+    std::vector<uint32_t> keys[2];
+    std::vector<int32_t> sizes[2];
+    std::vector<std::unique_ptr<char[]>> ballast;
+    for (int32_t run = 0; run < 2; ++run) {
+        cdd_init(100000, 10000, 10000);
+        cdd_add_clocks(3);
+        cdd_add_bddvar(2);
+        // TODO see issue #36 for this namespace and cdd_done() stuff.
+        {
+            keys[run] = build_keyed_diagram(sizes[run]);
+        }
+        cdd_done();
+        // Move the allocations of the next run
+        ballast.emplace_back(new char[3 * 0x10000 + 40]);
+    }
+    REQUIRE(keys[0] == keys[1]);
+    REQUIRE(sizes[0] == sizes[1]);
+    REQUIRE((keys[0].back() ^ keys[0][keys[0].size() - 2]) == 1);
+}
+
+/// (b0 & b3) | (b1 & b4) | (b2 & b5), guarded by a clock constraint: large in the declared order.
+static cdd build_pairs(int32_t b, const cdd& guard)
+{
+    return guard & ((cdd_bddvarpp(b) & cdd_bddvarpp(b + 3)) | (cdd_bddvarpp(b + 1) & cdd_bddvarpp(b + 4)) |
+                    (cdd_bddvarpp(b + 2) & cdd_bddvarpp(b + 5)));
+}
+
+TEST_CASE("CDD BDD variable reordering")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(2);
+    int32_t b = cdd_add_bddvar(6);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        cdd guard = cdd_intervalpp(1, 0, bnd_lower(2, false), bnd_upper(5, true));
+        cdd pairs = build_pairs(b, guard);
+        int32_t before = cdd_nodecount(pairs);
+
+        // Swapping keeps references valid and their meaning.
+        REQUIRE(cdd_swap_levels(b + 2) == 0);
+        REQUIRE(cdd_equiv(pairs, build_pairs(b, guard)));
+        REQUIRE(cdd_swap_levels(b + 2) == 0);
+        REQUIRE(cdd_swap_levels(b - 1) == CDD_VAR);
+        REQUIRE(cdd_nodecount(pairs) == before);
+
+        REQUIRE(cdd_reorder() > 0);
+        REQUIRE(cdd_nodecount(pairs) < before);
+        REQUIRE(cdd_equiv(pairs, build_pairs(b, guard)));
+
+        // Variables are still identified by the level they were added at.
+        for (int32_t v = 0; v < 64; ++v) {
+            bool bools[8] = {};
+            for (int32_t k = 0; k < 6; ++k)
+                bools[b + k] = (v >> k) & 1;
+            bool expected = (bools[b] && bools[b + 3]) || (bools[b + 1] && bools[b + 4]) ||
+                            (bools[b + 2] && bools[b + 5]);
+            int32_t clocks[2] = {0, 3};
+            REQUIRE(cdd_eval_point(pairs, clocks, bools) == expected);
+        }
+        int32_t level = b + 3;
+        cdd quantified = cdd_exist(pairs, &level, nullptr, 1, 0);
+        REQUIRE(cdd_equiv(quantified, guard & (cdd_bddvarpp(b) | (cdd_bddvarpp(b + 1) & cdd_bddvarpp(b + 4)) |
+                                               (cdd_bddvarpp(b + 2) & cdd_bddvarpp(b + 5)))));
+    }
+    cdd_done();
+}
+
+TEST_CASE("CDD automatic reordering")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(2);
+    int32_t b = cdd_add_bddvar(6);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        cdd guard = cdd_intervalpp(1, 0, bnd_lower(2, false), bnd_upper(5, true));
+        cdd pairs = build_pairs(b, guard);
+        int32_t before = cdd_nodecount(pairs);
+        cdd_autoreorder(before / 2);
+
+        // Not while a zone iterator is in progress.
+        cdd_zone_iterator it;
+        cdd_zone_iterator_init(&it, pairs.handle(), cdd_clocknum);
+        auto moved = [b] {
+            for (int32_t k = 0; k < 6; ++k)
+                if (cdd_var2level[b + k] != b + k)
+                    return true;
+            return false;
+        };
+        cdd copy = build_pairs(b, guard);
+        REQUIRE(!moved());
+        cdd_zone_iterator_done(&it);
+
+        // The operations reorder without an explicit garbage collection.
+        REQUIRE(cdd_equiv(pairs & guard, copy));
+        REQUIRE(moved());
+        REQUIRE(cdd_nodecount(pairs) < before);
+        REQUIRE(cdd_equiv(pairs, build_pairs(b, guard)));
+    }
+    cdd_done();
+}
+
+/// Clocks 1..3 take the same interval as clocks 4..6: large in the declared order.
+static cdd build_clock_pairs()
+{
+    cdd res = cdd_false();
+    for (int32_t v = 0; v < 8; ++v) {
+        cdd zone = cdd_true();
+        for (int32_t k = 0; k < 3; ++k) {
+            raw_t low = bnd_lower(2 * ((v >> k) & 1), false);
+            raw_t up = bnd_upper(2 * ((v >> k) & 1) + 1, false);
+            zone &= cdd_intervalpp(k + 1, 0, low, up) & cdd_intervalpp(k + 4, 0, low, up);
+        }
+        res |= zone;
+    }
+    return res;
+}
+
+TEST_CASE("CDD static variable order")
+{
+    const int32_t deps[] = {1, 0, 2, 0, 3, 0, 4, 0, 5, 0, 6, 0, 1, 4, 2, 5, 3, 6};
+    int32_t counts[2];
+    for (int32_t ordered = 0; ordered < 2; ++ordered) {
+        cdd_init(100000, 10000, 10000);
+        if (ordered) {
+            cdd_add_clocks_ordered(7, deps, 9);
+        } else {
+            cdd_add_clocks(7);
+        }
+        // TODO see issue #36 for this namespace and cdd_done() stuff.
+        {
+            REQUIRE(cdd_get_level_count() == 21);
+            for (int32_t i = 1; i < 7; ++i) {
+                for (int32_t j = 0; j < i; ++j) {
+                    const LevelInfo* info = cdd_get_levelinfo(cdd_diff2level[cdd_difference(i, j)]);
+                    REQUIRE((info->clock1 == i && info->clock2 == j));
+                }
+            }
+            cdd pairs = build_clock_pairs();
+            counts[ordered] = cdd_nodecount(pairs);
+        }
+        cdd_done();
+    }
+    REQUIRE(counts[1] < counts[0]);
+}
+
+/// Whether clocks 1..3 take the same interval as clocks 4..6 in \a clocks.
+static bool eval_clock_pairs(const int32_t* clocks)
+{
+    for (int32_t k = 1; k <= 3; ++k) {
+        if (clocks[k] > 3 || clocks[k] / 2 != clocks[k + 3] / 2 || clocks[k + 3] > 3)
+            return false;
+    }
+    return true;
+}
+
+/// The union of the zones in \a zones.
+static cdd build_union(const std::vector<dbm_wrap>& zones)
+{
+    cdd res = cdd_false();
+    for (const auto& zone : zones)
+        res |= cdd(zone.raw(), zone.size());
+    return res;
+}
+
+TEST_CASE("CDD clock difference reordering")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(7);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        cdd pairs = build_clock_pairs();
+        cdd positive = cdd_remove_negative(pairs);
+        std::vector<dbm_wrap> zones(20, dbm_wrap{7});
+        for (auto& zone : zones)
+            zone.generate();
+        cdd random = build_union(zones);
+
+        // Swapping keeps references valid and their meaning. A swap that
+        // would move a node referenced from outside is refused, so which
+        // difference ends at the last level depends on the random zones.
+        for (int32_t level = 0; level + 1 < cdd_get_level_count(); ++level) {
+            int32_t err = cdd_swap_levels(level);
+            REQUIRE((err == 0 || err == CDD_SWAP));
+            REQUIRE(cdd_equiv(pairs, build_clock_pairs()));
+            REQUIRE(cdd_equiv(random, build_union(zones)));
+        }
+
+        // Sifting never ends with more nodes than it started with.
+        cdd_stats stats;
+        REQUIRE(cdd_get_stats(&stats) == 0);
+        int32_t before = stats.alive;
+        cdd_free_stats(&stats);
+        int32_t after = cdd_reorder();
+        REQUIRE(after > 0);
+        REQUIRE(after <= before);
+        REQUIRE(cdd_equiv(pairs, build_clock_pairs()));
+        REQUIRE(cdd_equiv(random, build_union(zones)));
+        REQUIRE(cdd_equiv(positive, cdd_remove_negative(pairs)));
+        for (int32_t v = 0; v < 4096; ++v) {
+            int32_t clocks[7] = {0};
+            for (int32_t k = 1; k < 7; ++k)
+                clocks[k] = (v >> (2 * (k - 1))) & 3;
+            REQUIRE(cdd_eval_point(pairs, clocks, nullptr) == eval_clock_pairs(clocks));
+        }
+
+        // The levels still know their clocks.
+        for (int32_t i = 1; i < 7; ++i) {
+            for (int32_t j = 0; j < i; ++j) {
+                const LevelInfo* info = cdd_get_levelinfo(cdd_diff2level[cdd_difference(i, j)]);
+                REQUIRE((info->clock1 == i && info->clock2 == j));
+            }
+        }
+    }
+    cdd_done();
+}
+
+static int32_t options_chunks = 0;
+static int32_t options_rehashes = 0;
+
+// Chunks must be aligned to their size, as in cdd_allocate_chunk_from_os().
+static void* options_chunk_alloc(size_t size)
+{
+    void* chunk = nullptr;
+    ++options_chunks;
+#ifdef _WIN32
+    chunk = _aligned_malloc(size, size);
+#else
+    if (posix_memalign(&chunk, size, size) != 0) {
+        chunk = nullptr;
+    }
+#endif
+    return chunk;
+}
+
+static void options_chunk_free(void* chunk)
+{
+    --options_chunks;
+#ifdef _WIN32
+    _aligned_free(chunk);
+#else
+    std::free(chunk);
+#endif
+}
+
+static void options_count_rehash(CddRehashStat*) { ++options_rehashes; }
+
+TEST_CASE("CDD initialisation options")
+{
+    cdd_options options;
+    cdd_default_options(&options, 100000, 10000, 10000);
+    options.quant_cache = 0;
+    REQUIRE(cdd_init_ex(&options) == CDD_RANGE);
+    REQUIRE(!cdd_isrunning());
+
+    int32_t chunks[2], rehashes[2];
+    for (int32_t sized = 0; sized < 2; ++sized) {
+        cdd_default_options(&options, 100000, 10000, 10000);
+        options.chunk_alloc = options_chunk_alloc;
+        options.chunk_free = options_chunk_free;
+        if (sized) {
+            options.bdd_nodes = 20000;
+            options.cdd_nodes = 4000;
+            options.buckets = 1024;
+        }
+        options_rehashes = 0;
+        REQUIRE(cdd_init_ex(&options) == 0);
+        chunks[sized] = options_chunks;
+        cdd_add_clocks(2);
+        cdd_postrehash_hook(options_count_rehash);
+
+        // TODO see issue #36 for this namespace and cdd_done() stuff.
+        {
+            std::vector<cdd> intervals;
+            for (int32_t k = 0; k < 3000; ++k) {
+                intervals.push_back(cdd_intervalpp(1, 0, bnd_lower(k, false), bnd_upper(k + 1, false)));
+            }
+            REQUIRE(cdd_nodecount(intervals.back()) == 1);
+        }
+        rehashes[sized] = options_rehashes;
+        cdd_done();
+        REQUIRE(options_chunks == 0);
+    }
+    REQUIRE(chunks[1] > chunks[0]);
+    REQUIRE(rehashes[0] > 0);
+    REQUIRE(rehashes[1] == 0);
+}
+
+static int32_t rehashes_begun = 0;
+static int32_t rehashes_ended = 0;
+
+static void rehash_begin() { REQUIRE(rehashes_begun++ == rehashes_ended); }
+
+static void rehash_end(CddRehashStat* s)
+{
+    REQUIRE(++rehashes_ended == rehashes_begun);
+    REQUIRE(s->num == rehashes_ended);
+}
+
+TEST_CASE("CDD rehash hooks bracket each rehash")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(2);
+    cdd_prerehash_hook(rehash_begin);
+    cdd_postrehash_hook(rehash_end);
+    rehashes_begun = rehashes_ended = 0;
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        std::vector<cdd> intervals;
+        for (int32_t k = 0; k < 3000; ++k) {
+            intervals.push_back(cdd_intervalpp(1, 0, bnd_lower(k, false), bnd_upper(k + 1, false)));
+        }
+    }
+    cdd_done();
+    REQUIRE(rehashes_ended > 0);
+    REQUIRE(rehashes_begun == rehashes_ended);
+}
+
+TEST_CASE("CDD statistics")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(3);
+    int32_t b = cdd_add_bddvar(2);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        cdd zone = cdd_intervalpp(1, 0, bnd_lower(1, false), bnd_upper(4, false));
+        cdd other = cdd_intervalpp(2, 1, bnd_lower(0, true), bnd_upper(2, false));
+        cdd_reset_stats();
+        {
+            // Dropping the result leaves dead nodes, which the cache
+            // hit of the same operation brings back
+            cdd tmp = (zone & cdd_bddvarpp(b)) | (other & cdd_bddnvarpp(b + 1));
+        }
+        cdd res = (zone & cdd_bddvarpp(b)) | (other & cdd_bddnvarpp(b + 1));
+
+        cdd_stats stats;
+        REQUIRE(cdd_get_stats(&stats) == 0);
+        REQUIRE(stats.apply.lookups > stats.apply.hits);
+        REQUIRE(stats.apply.hits > 0);
+        REQUIRE(stats.apply.size == 10000);
+        REQUIRE(stats.reclaims > 0);
+        REQUIRE(stats.managernum >= 2);
+        REQUIRE(stats.managers[0].type == TYPE_BDD);
+        int32_t alive = 0, inserts = 0;
+        for (int32_t i = 0; i < stats.managernum; ++i) {
+            const cdd_manager_stats& m = stats.managers[i];
+            REQUIRE(m.chunkbytes > 0);
+            REQUIRE(m.peak >= m.alive + m.dead);
+            alive += m.alive;
+            for (int32_t k = 0; k < m.levelnum; ++k) {
+                REQUIRE(m.levels[k].lookups >= m.levels[k].inserts);
+                REQUIRE((m.levels[k].keys == 0 || m.levels[k].chain >= 1.0));
+                inserts += m.levels[k].inserts;
+            }
+        }
+        REQUIRE(alive == stats.alive);
+        REQUIRE(alive >= cdd_nodecount(res));
+        REQUIRE(inserts > 0);
+        REQUIRE(stats.peak >= stats.alive + stats.dead);
+        cdd_free_stats(&stats);
+        REQUIRE(stats.managers == nullptr);
+
+        cdd_reset_stats();
+        REQUIRE(cdd_get_stats(&stats) == 0);
+        REQUIRE(stats.apply.lookups == 0);
+        REQUIRE(stats.reclaims == 0);
+        REQUIRE(stats.peak == stats.alive + stats.dead);
+        cdd_free_stats(&stats);
+    }
+    cdd_done();
+}
+
+#ifdef CDD_TRACE
+static size_t count_occurrences(const std::string& text, const std::string& word)
+{
+    size_t n = 0;
+    for (size_t pos = text.find(word); pos != std::string::npos; pos = text.find(word, pos + 1))
+        ++n;
+    return n;
+}
+
+static std::string dump_trace()
+{
+    FILE* file = tmpfile();
+    REQUIRE(file != nullptr);
+    REQUIRE(cdd_trace_dump(file) == 0);
+    std::string json;
+    rewind(file);
+    for (int c = fgetc(file); c != EOF; c = fgetc(file))
+        json += static_cast<char>(c);
+    fclose(file);
+    return json;
+}
+
+TEST_CASE("CDD tracing")
+{
+    cdd_init(100000, 10000, 10000);
+    cdd_add_clocks(3);
+    int32_t b = cdd_add_bddvar(1);
+
+    // TODO see issue #36 for this namespace and cdd_done() stuff.
+    {
+        cdd zone = cdd_intervalpp(1, 0, bnd_lower(1, false), bnd_upper(4, false));
+        cdd other = cdd_intervalpp(2, 1, bnd_lower(0, true), bnd_upper(2, false));
+        cdd guard = cdd_bddvarpp(b);
+        int32_t resets[] = {1};
+        int32_t values[] = {0};
+
+        REQUIRE(cdd_trace_start(16) == 0);
+        cdd both = zone & other;
+        cdd reduced = cdd_reduce(both);
+        cdd delayed = cdd_delay(reduced);
+        REQUIRE(cdd_trace_size() == 3);
+        // The operations used by cdd_predt() and cdd_transition() are
+        // part of their events
+        cdd pred = cdd_predt(zone, other);
+        cdd succ = cdd_transition(zone, guard, resets, values, 1, nullptr, nullptr, 0);
+        REQUIRE(cdd_trace_size() == 5);
+        cdd_trace_stop();
+        cdd after = zone & guard;
+        REQUIRE(cdd_trace_size() == 5);
+
+        std::string json = dump_trace();
+        REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+        REQUIRE(count_occurrences(json, "\"ph\":\"X\"") == 5);
+        REQUIRE(count_occurrences(json, "\"name\":\"cdd_apply\"") == 1);
+        REQUIRE(count_occurrences(json, "\"name\":\"cdd_reduce\"") == 1);
+        REQUIRE(count_occurrences(json, "\"name\":\"cdd_delay\"") == 1);
+        REQUIRE(count_occurrences(json, "\"name\":\"cdd_predt\"") == 1);
+        REQUIRE(count_occurrences(json, "\"name\":\"cdd_transition\"") == 1);
+        std::string apply = "\"args\":{\"op\":" + std::to_string(cddop_and) + ",\"left\":" +
+                            std::to_string(cdd_nodecount(zone)) + ",\"right\":" +
+                            std::to_string(cdd_nodecount(other)) +
+                            ",\"result\":" + std::to_string(cdd_nodecount(both)) + "}";
+        REQUIRE(json.find(apply) != std::string::npos);
+        REQUIRE(json.find("\"dropped\":\"0\"") != std::string::npos);
+
+        // A full ring buffer keeps the newest events
+        REQUIRE(cdd_trace_start(2) == 0);
+        cdd first = zone & other;
+        cdd second = cdd_reduce(first);
+        cdd third = cdd_delay(second);
+        REQUIRE(cdd_trace_size() == 2);
+        json = dump_trace();
+        REQUIRE(count_occurrences(json, "\"name\":\"cdd_apply\"") == 0);
+        REQUIRE(json.find("cdd_reduce") < json.find("cdd_delay"));
+        REQUIRE(json.find("\"dropped\":\"1\"") != std::string::npos);
+    }
+    cdd_done();
+}
+#endif
+
 TEST_CASE("CDD timed predecessor static test")
 {
     cdd_init(100000, 10000, 10000);
@@ -1042,16 +2018,14 @@ TEST_CASE("CDD BDD to array test")
     cdd_done();
 }
 
-// TODO: the bellow test case passes only on 32-bit, need to fix it
-#if INTPTR_MAX == INT32_MAX
 TEST_CASE("CDD reduce with size 3")
 {
     cdd_init(100000, 10000, 10000);
     cdd_add_clocks(3);
     cdd_add_bddvar(3);
     test_reduce(3);
+    cdd_done();
 }
-#endif /* 32-bit */
 
 TEST_CASE("Big CDD test")
 {
@@ -1061,9 +2035,6 @@ TEST_CASE("Big CDD test")
     SUBCASE("Size 0") { big_test(0); }
     SUBCASE("Size 1") { big_test(1); }
     SUBCASE("Size 2") { big_test(2); }
-    // TODO: the bellow cases pass only on 32-bit, need to fix it
-#if INTPTR_MAX == INT32_MAX
     SUBCASE("Size 3") { big_test(3); }
     SUBCASE("Size 10") { big_test(10); }
-#endif /* 32-bit */
 }